@@ -0,0 +1,140 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "AttributeIndex.h"
+#include <algorithm>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define MAX_LEVELS 64 // bitmaps kept per attribute
+#define WORD_BITS 64
+
+
+/**
+ * builds the bitmaps
+ * @param vectors the attribute vectors, all of the same length, index i is movie i
+ * @return 0 upon success, -1 when there are no movies
+ */
+int AttributeIndex::build(const std::vector<const std::vector<double> *> &vectors)
+{
+    if (vectors.empty())
+    {
+        return BUILD_FAIL;
+    }
+    _moviesNum = vectors.size();
+    _words = (_moviesNum + WORD_BITS - 1) / WORD_BITS;
+    size_t dims = vectors[0]->size();
+    _levels.assign(dims, std::vector<double>());
+    _atLeast.assign(dims, std::vector<uint64_t>());
+    _exact.assign(dims, true);
+    std::vector<double> values(_moviesNum);
+    for (size_t j = 0; j < dims; j++)
+    {
+        for (size_t i = 0; i < _moviesNum; i++)
+        {
+            values[i] = (*vectors[i])[j];
+        }
+        std::vector<double> distinct(values);
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        std::vector<double> &levels = _levels[j];
+        if (distinct.size() <= MAX_LEVELS)
+        {
+            levels = distinct;
+        }
+        else
+        { // evenly spaced distinct values, starting with the smallest so every movie is covered
+            for (size_t l = 0; l < MAX_LEVELS; l++)
+            {
+                levels.push_back(distinct[l * distinct.size() / MAX_LEVELS]);
+            }
+            _exact[j] = false;
+        }
+        std::vector<uint64_t> &bitmaps = _atLeast[j];
+        bitmaps.assign(levels.size() * _words, 0);
+        for (size_t i = 0; i < _moviesNum; i++)
+        { // the movie is at least every level up to the last one not above its value
+            size_t top = std::upper_bound(levels.begin(), levels.end(), values[i]) -
+                         levels.begin();
+            for (size_t l = 0; l < top; l++)
+            {
+                bitmaps[l * _words + i / WORD_BITS] |= (uint64_t) 1 << (i % WORD_BITS);
+            }
+        }
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool AttributeIndex::isBuilt() const
+{
+    return _moviesNum != 0;
+}
+
+/**
+ * ands allowed with the movies whose attribute is at least the given level
+ * @param attribute
+ * @param level index into the levels of the attribute, may be past the last one
+ * @param negate true to and with the movies below the level instead
+ * @param allowed the bitmap to narrow
+ * @param words its length in 64 bit words
+ */
+void AttributeIndex::_and(size_t attribute, size_t level, bool negate, uint64_t *allowed,
+                          size_t words) const
+{
+    if (level >= _levels[attribute].size())
+    { // no movie reaches the level
+        if (!negate)
+        {
+            std::fill(allowed, allowed + words, 0);
+        }
+        return;
+    }
+    const uint64_t *bitmap = &_atLeast[attribute][level * _words];
+    for (size_t w = 0; w < _words && w < words; w++)
+    {
+        allowed[w] &= negate ? ~bitmap[w] : bitmap[w];
+    }
+}
+
+/**
+ * narrows a bitmap of movies to the movies that may pass all the filters
+ * @param filters
+ * @param allowed bit i of word i / 64 is movie i. its movies that fail a filter are cleared
+ * @param words the length of allowed in 64 bit words
+ * @return true if the remaining movies are exactly the ones passing the filters, false if
+ * they are a superset which should be checked with AttributeFilter::matches
+ */
+bool AttributeIndex::select(const std::vector<AttributeFilter> &filters, uint64_t *allowed,
+                            size_t words) const
+{
+    bool exact = true;
+    for (const AttributeFilter &filter : filters)
+    {
+        if (filter.attribute >= _levels.size())
+        {
+            std::fill(allowed, allowed + words, 0);
+            continue;
+        }
+        const std::vector<double> &levels = _levels[filter.attribute];
+        size_t min;
+        if (_exact[filter.attribute])
+        { // every value is a level, so at least min means at least the first level from min
+            min = std::lower_bound(levels.begin(), levels.end(), filter.min) - levels.begin();
+        }
+        else
+        { // the last level not above min keeps every movie from min, and maybe a few below it
+            min = std::upper_bound(levels.begin(), levels.end(), filter.min) - levels.begin();
+            min = (min == 0) ? 0 : min - 1;
+        }
+        _and(filter.attribute, min, false, allowed, words);
+        // at most max means below the first level above max
+        size_t max = std::upper_bound(levels.begin(), levels.end(), filter.max) - levels.begin();
+        _and(filter.attribute, max, true, allowed, words);
+        exact = exact && _exact[filter.attribute];
+    }
+    return exact;
+}
@@ -0,0 +1,80 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_ATTRIBUTEINDEX_H
+#define EX5_ATTRIBUTEINDEX_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * a condition on one movie attribute: min <= attribute <= max
+ */
+struct AttributeFilter
+{
+    size_t attribute; // index of the attribute in the attribute vectors
+    double min;
+    double max;
+
+    /**
+     * @param vec a movie attribute vector
+     * @return true if the movie passes the filter
+     */
+    bool matches(const std::vector<double> &vec) const
+    {
+        return attribute < vec.size() && vec[attribute] >= min && vec[attribute] <= max;
+    }
+};
+
+/**
+ * range encoded bitmap indexes of the movie attributes. for every attribute it keeps up to
+ * MAX_LEVELS increasing levels, and for every level the bitmap of the movies whose attribute is
+ * at least that level. a filter then becomes a few word wise ands over the bitmaps instead of a
+ * pass over the attribute vectors. attributes with few distinct values (like the 1-10 of the
+ * movie files) get a level per value and their bitmaps are exact; the others get a superset,
+ * which the caller narrows with AttributeFilter::matches.
+ */
+class AttributeIndex
+{
+private:
+    size_t _moviesNum = 0;
+    size_t _words = 0; // 64 bit words per bitmap
+    std::vector<std::vector<double> > _levels; // the increasing levels of each attribute
+    std::vector<std::vector<uint64_t> > _atLeast; // level l of attribute j starts at l * _words
+    std::vector<bool> _exact; // true if every value of the attribute is a level
+    /**
+     * ands allowed with the movies whose attribute is at least the given level
+     * @param attribute
+     * @param level index into the levels of the attribute, may be past the last one
+     * @param negate true to and with the movies below the level instead
+     * @param allowed the bitmap to narrow
+     * @param words its length in 64 bit words
+     */
+    void _and(size_t attribute, size_t level, bool negate, uint64_t *allowed, size_t words) const;
+public:
+    /**
+     * builds the bitmaps
+     * @param vectors the attribute vectors, all of the same length, index i is movie i
+     * @return 0 upon success, -1 when there are no movies
+     */
+    int build(const std::vector<const std::vector<double> *> &vectors);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * narrows a bitmap of movies to the movies that may pass all the filters
+     * @param filters
+     * @param allowed bit i of word i / 64 is movie i. its movies that fail a filter are cleared
+     * @param words the length of allowed in 64 bit words
+     * @return true if the remaining movies are exactly the ones passing the filters, false if
+     * they are a superset which should be checked with AttributeFilter::matches
+     */
+    bool select(const std::vector<AttributeFilter> &filters, uint64_t *allowed,
+                size_t words) const;
+};
+
+
+#endif //EX5_ATTRIBUTEINDEX_H
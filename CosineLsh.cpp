@@ -0,0 +1,121 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "CosineLsh.h"
+#include "VectorMath.h"
+#include <random>
+#include <algorithm>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define PLANES_SEED 1234u
+#define MAX_BITS 64
+
+
+/**
+ * draws the hyperplanes and computes the signatures of every vector
+ * @param vectors the vectors to hash, all of the same length, index i is movie i
+ * @param tables number of signatures per movie
+ * @param bits number of hyperplanes per signature, between 1 and 64
+ * @return 0 upon success, -1 upon invalid parameters
+ */
+int CosineLsh::build(const std::vector<const std::vector<double> *> &vectors, int tables,
+                     int bits)
+{
+    if (tables <= 0 || bits <= 0 || bits > MAX_BITS || vectors.empty())
+    {
+        return BUILD_FAIL;
+    }
+    _dims = vectors[0]->size();
+    _tables = tables;
+    _bits = bits;
+    // gaussian normals make the hyperplane directions uniform on the sphere
+    std::mt19937 gen(PLANES_SEED);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    _planes.resize(_tables * _bits * _dims);
+    for (double &elem : _planes)
+    {
+        elem = dist(gen);
+    }
+    _signatures.resize(vectors.size() * _tables);
+    for (size_t i = 0; i < vectors.size(); i++)
+    {
+        std::vector<uint64_t> cur = signature(*vectors[i]);
+        std::copy(cur.begin(), cur.end(), &_signatures[i * _tables]);
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool CosineLsh::isBuilt() const
+{
+    return _tables > 0;
+}
+
+/**
+ * @param vec a vector of the hashed length
+ * @return its signatures, one per table
+ */
+std::vector<uint64_t> CosineLsh::signature(const std::vector<double> &vec) const
+{
+    std::vector<uint64_t> out(_tables, 0);
+    for (int t = 0; t < _tables; t++)
+    {
+        for (int b = 0; b < _bits; b++)
+        {
+            const double *plane = &_planes[(t * _bits + b) * _dims];
+            if (VectorMath::dotProd(plane, vec.data(), _dims) >= 0.0)
+            {
+                out[t] |= (uint64_t) 1 << b;
+            }
+        }
+    }
+    return out;
+}
+
+/**
+ * @param movie
+ * @return the signatures of a hashed movie, one per table
+ */
+const uint64_t *CosineLsh::movieSignature(size_t movie) const
+{
+    return &_signatures[movie * _tables];
+}
+
+/**
+ * finds the allowed movies whose signatures are closest to the given ones
+ * @param signature one signature per table
+ * @param count max number of candidates
+ * @param allowed which movies may be returned
+ * @return up to count movies, by increasing total hamming distance over the tables
+ */
+std::vector<size_t> CosineLsh::candidates(const uint64_t *signature, size_t count,
+                                          const std::function<bool(size_t)> &allowed) const
+{
+    std::vector<std::pair<int, size_t> > distances;
+    size_t moviesNum = _signatures.size() / _tables;
+    for (size_t i = 0; i < moviesNum; i++)
+    {
+        if (allowed(i))
+        {
+            const uint64_t *cur = &_signatures[i * _tables];
+            int distance = 0;
+            for (int t = 0; t < _tables; t++)
+            {
+                distance += __builtin_popcountll(cur[t] ^ signature[t]);
+            }
+            distances.emplace_back(distance, i);
+        }
+    }
+    count = std::min(count, distances.size());
+    std::partial_sort(distances.begin(), distances.begin() + count, distances.end());
+    std::vector<size_t> out(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = distances[i].second;
+    }
+    return out;
+}
@@ -0,0 +1,62 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_COSINELSH_H
+#define EX5_COSINELSH_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+/**
+ * random hyperplane locality sensitive hashing for cosine similarity. every movie gets, per
+ * table, a signature of up to 64 bits: the side of each random hyperplane its vector lies on.
+ * the fraction of differing bits between two signatures estimates the angle between the
+ * vectors divided by pi, so the hamming distance (a popcount) ranks movies by cosine cheaply.
+ */
+class CosineLsh
+{
+private:
+    size_t _dims = 0;
+    int _tables = 0; // 0 while not built
+    int _bits = 0; // bits per table signature
+    std::vector<double> _planes; // _tables * _bits hyperplanes of length _dims, row major
+    std::vector<uint64_t> _signatures; // _tables signatures per movie, movie major
+public:
+    /**
+     * draws the hyperplanes and computes the signatures of every vector
+     * @param vectors the vectors to hash, all of the same length, index i is movie i
+     * @param tables number of signatures per movie
+     * @param bits number of hyperplanes per signature, between 1 and 64
+     * @return 0 upon success, -1 upon invalid parameters
+     */
+    int build(const std::vector<const std::vector<double> *> &vectors, int tables, int bits);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * @param vec a vector of the hashed length
+     * @return its signatures, one per table
+     */
+    std::vector<uint64_t> signature(const std::vector<double> &vec) const;
+    /**
+     * @param movie
+     * @return the signatures of a hashed movie, one per table
+     */
+    const uint64_t *movieSignature(size_t movie) const;
+    /**
+     * finds the allowed movies whose signatures are closest to the given ones
+     * @param signature one signature per table
+     * @param count max number of candidates
+     * @param allowed which movies may be returned
+     * @return up to count movies, by increasing total hamming distance over the tables
+     */
+    std::vector<size_t> candidates(const uint64_t *signature, size_t count,
+                                   const std::function<bool(size_t)> &allowed) const;
+};
+
+
+#endif //EX5_COSINELSH_H
@@ -0,0 +1,249 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "DenseModel.h"
+#include <cmath>
+#include <algorithm>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define NO_MOVIE -1
+#define LANES 16 // floats in an avx512 register, or two avx2 registers
+#define ACCUMULATORS 8
+
+
+/**
+ * copies the data into the model
+ * @param attributes the attribute vector of every movie, all of the same length
+ * @param ranks the rank vector of every client, in the order of the movies
+ * @return 0 upon success, -1 when there are no movies
+ */
+template<class Scalar>
+int DenseModel<Scalar>::build(const std::vector<const std::vector<double> *> &attributes,
+                              const std::vector<const std::vector<double> *> &ranks)
+{
+    if (attributes.empty())
+    {
+        return BUILD_FAIL;
+    }
+    _moviesNum = attributes.size();
+    _dims = attributes[0]->size();
+    _stride = (_dims + LANES - 1) / LANES * LANES;
+    _attributes.assign(_moviesNum * _stride, 0);
+    _norms.assign(_moviesNum, 0);
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        Scalar *row = &_attributes[i * _stride];
+        std::copy(attributes[i]->begin(), attributes[i]->end(), row);
+        _norms[i] = std::sqrt(dotProd(row, row, _stride));
+    }
+    _ranks.assign(ranks.size() * _moviesNum, 0);
+    for (size_t u = 0; u < ranks.size(); u++)
+    {
+        std::copy(ranks[u]->begin(), ranks[u]->end(), &_ranks[u * _moviesNum]);
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+template<class Scalar>
+bool DenseModel<Scalar>::isBuilt() const
+{
+    return _moviesNum != 0;
+}
+
+/**
+ * @return the bytes held by the model
+ */
+template<class Scalar>
+size_t DenseModel<Scalar>::bytes() const
+{
+    return (_attributes.size() + _norms.size() + _ranks.size()) * sizeof(Scalar);
+}
+
+/**
+ * the preference vector of a client, as recommendByContent builds it
+ * @param client
+ * @param pref output, padded to the stride
+ */
+template<class Scalar>
+void DenseModel<Scalar>::_prefVec(size_t client, std::vector<Scalar> &pref) const
+{
+    const Scalar *ranks = &_ranks[client * _moviesNum];
+    Scalar sum = 0;
+    size_t ranked = 0;
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        sum += ranks[i];
+        ranked += (ranks[i] != 0);
+    }
+    Scalar avg = (ranked != 0) ? sum / ranked : 0;
+    pref.assign(_stride, 0);
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        if (ranks[i] != 0 && ranks[i] != avg)
+        {
+            Scalar scalar = ranks[i] - avg;
+            const Scalar *movie = &_attributes[i * _stride];
+            for (size_t j = 0; j < _stride; j++)
+            {
+                pref[j] += scalar * movie[j];
+            }
+        }
+    }
+}
+
+/**
+ * the content based recommendation of the recommender
+ * @param client
+ * @return the unwatched movie most similar to the client's preferences, -1 if there is none
+ */
+template<class Scalar>
+long DenseModel<Scalar>::recommendByContent(size_t client) const
+{
+    std::vector<Scalar> pref;
+    _prefVec(client, pref);
+    Scalar prefNorm = std::sqrt(dotProd(pref.data(), pref.data(), _stride));
+    const Scalar *ranks = &_ranks[client * _moviesNum];
+    long closest = NO_MOVIE;
+    Scalar closestScore = (Scalar) -HUGE_VAL;
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        if (ranks[i] == 0)
+        {
+            Scalar curScore = dotProd(&_attributes[i * _stride], pref.data(), _stride) /
+                              (_norms[i] * prefNorm);
+            if (curScore > closestScore)
+            {
+                closestScore = curScore;
+                closest = (long) i;
+            }
+        }
+    }
+    return closest;
+}
+
+/**
+ * predict, for a client whose ranked movies are already listed
+ * @param movie
+ * @param ranks the client's rank row
+ * @param ranked the movies the client ranked
+ * @param k
+ * @param scored scratch space, reused between calls
+ * @return the prediction
+ */
+template<class Scalar>
+Scalar DenseModel<Scalar>::_predict(size_t movie, const Scalar *ranks,
+                                    const std::vector<unsigned int> &ranked, int k,
+                                    std::vector<std::pair<Scalar, unsigned int> > &scored) const
+{
+    const Scalar *target = &_attributes[movie * _stride];
+    scored.clear();
+    for (unsigned int j : ranked)
+    {
+        scored.emplace_back(dotProd(target, &_attributes[j * _stride], _stride) /
+                            (_norms[j] * _norms[movie]), j);
+    }
+    size_t keep = std::min(ranked.size(), (size_t) std::max(k, 0));
+    std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                      [](const std::pair<Scalar, unsigned int> &lhs,
+                         const std::pair<Scalar, unsigned int> &rhs)
+    {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    });
+    Scalar numerator = 0;
+    Scalar denominator = 0;
+    for (size_t p = 0; p < keep; p++)
+    {
+        numerator += scored[p].first * ranks[scored[p].second];
+        denominator += scored[p].first;
+    }
+    return numerator / denominator;
+}
+
+/**
+ * the cf prediction of the recommender: the similarity weighted average of the client's
+ * ranks of the k ranked movies most similar to the movie, ties going to the lower index
+ * @param movie
+ * @param client
+ * @param k at most the number of movies the client ranked
+ * @return the prediction
+ */
+template<class Scalar>
+Scalar DenseModel<Scalar>::predict(size_t movie, size_t client, int k) const
+{
+    const Scalar *ranks = &_ranks[client * _moviesNum];
+    std::vector<unsigned int> ranked;
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        if (ranks[i] != 0)
+        {
+            ranked.push_back((unsigned int) i);
+        }
+    }
+    std::vector<std::pair<Scalar, unsigned int> > scored;
+    return _predict(movie, ranks, ranked, k, scored);
+}
+
+/**
+ * the cf recommendation of the recommender
+ * @param client
+ * @param k
+ * @return the unwatched movie with the highest prediction, -1 if there is none
+ */
+template<class Scalar>
+long DenseModel<Scalar>::recommendByCF(size_t client, int k) const
+{
+    const Scalar *ranks = &_ranks[client * _moviesNum];
+    std::vector<unsigned int> ranked;
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        if (ranks[i] != 0)
+        {
+            ranked.push_back((unsigned int) i);
+        }
+    }
+    std::vector<std::pair<Scalar, unsigned int> > scored;
+    long best = NO_MOVIE;
+    Scalar bestScore = (Scalar) -HUGE_VAL;
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        if (ranks[i] == 0)
+        {
+            Scalar curScore = _predict(i, ranks, ranked, k, scored);
+            if (bestScore < curScore)
+            {
+                bestScore = curScore;
+                best = (long) i;
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * dot product of two padded rows
+ * @param a first vector
+ * @param b second vector
+ * @param n length of both vectors, a multiple of the simd width
+ * @return the dot product
+ */
+template<class Scalar>
+Scalar DenseModel<Scalar>::dotProd(const Scalar *a, const Scalar *b, size_t n)
+{ // independent accumulators, which the compiler keeps in the lanes of one register
+    Scalar acc[ACCUMULATORS] = {};
+    for (size_t j = 0; j < n; j += ACCUMULATORS)
+    {
+        for (size_t lane = 0; lane < ACCUMULATORS; lane++)
+        {
+            acc[lane] += a[j + lane] * b[j + lane];
+        }
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+template class DenseModel<float>;
+template class DenseModel<double>;
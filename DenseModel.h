@@ -0,0 +1,97 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_DENSEMODEL_H
+#define EX5_DENSEMODEL_H
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+/**
+ * a flat copy of the attributes and the ranks in a configurable scalar type, running the content
+ * and cf algorithms of the recommender on contiguous rows instead of the string keyed maps.
+ * the model is an extra copy next to the data it was built from, so it adds to the memory held;
+ * what DenseModel<float> halves is the bytes its scans read, and its kernels fit twice as many
+ * values in a simd register, at the cost of float rounding in the scores. it is compiled for
+ * float and double.
+ */
+template<class Scalar>
+class DenseModel
+{
+private:
+    size_t _dims = 0;
+    size_t _stride = 0; // _dims rounded up to a whole simd register, the padding is zero
+    size_t _moviesNum = 0;
+    std::vector<Scalar> _attributes; // movie i starts at i * _stride
+    std::vector<Scalar> _norms; // norm of each movie's attributes
+    std::vector<Scalar> _ranks; // client u starts at u * _moviesNum, 0 means not ranked
+    /**
+     * the preference vector of a client, as recommendByContent builds it
+     * @param client
+     * @param pref output, padded to the stride
+     */
+    void _prefVec(size_t client, std::vector<Scalar> &pref) const;
+    /**
+     * predict, for a client whose ranked movies are already listed
+     * @param movie
+     * @param ranks the client's rank row
+     * @param ranked the movies the client ranked
+     * @param k
+     * @param scored scratch space, reused between calls
+     * @return the prediction
+     */
+    Scalar _predict(size_t movie, const Scalar *ranks, const std::vector<unsigned int> &ranked,
+                    int k, std::vector<std::pair<Scalar, unsigned int> > &scored) const;
+public:
+    /**
+     * copies the data into the model
+     * @param attributes the attribute vector of every movie, all of the same length
+     * @param ranks the rank vector of every client, in the order of the movies
+     * @return 0 upon success, -1 when there are no movies
+     */
+    int build(const std::vector<const std::vector<double> *> &attributes,
+              const std::vector<const std::vector<double> *> &ranks);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * @return the bytes held by the model
+     */
+    size_t bytes() const;
+    /**
+     * the content based recommendation of the recommender
+     * @param client
+     * @return the unwatched movie most similar to the client's preferences, -1 if there is none
+     */
+    long recommendByContent(size_t client) const;
+    /**
+     * the cf prediction of the recommender: the similarity weighted average of the client's
+     * ranks of the k ranked movies most similar to the movie, ties going to the lower index
+     * @param movie
+     * @param client
+     * @param k at most the number of movies the client ranked
+     * @return the prediction
+     */
+    Scalar predict(size_t movie, size_t client, int k) const;
+    /**
+     * the cf recommendation of the recommender
+     * @param client
+     * @param k
+     * @return the unwatched movie with the highest prediction, -1 if there is none
+     */
+    long recommendByCF(size_t client, int k) const;
+    /**
+     * dot product of two padded rows
+     * @param a first vector
+     * @param b second vector
+     * @param n length of both vectors, a multiple of the simd width
+     * @return the dot product
+     */
+    static Scalar dotProd(const Scalar *a, const Scalar *b, size_t n);
+};
+
+
+#endif //EX5_DENSEMODEL_H
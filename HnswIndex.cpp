@@ -0,0 +1,295 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "HnswIndex.h"
+#include "VectorMath.h"
+#include <queue>
+#include <cmath>
+#include <algorithm>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define LEVELS_SEED 42u
+#define MIN_LINKS 2
+
+
+/**
+ * builds the index
+ * @param vectors the vectors to index, all of the same length, index i is node i
+ * @param m links kept per node, at least 2
+ * @param efConstruction candidates kept while inserting
+ * @return 0 upon success, -1 upon invalid parameters
+ */
+int HnswIndex::build(const std::vector<const std::vector<double> *> &vectors, int m,
+                     int efConstruction)
+{
+    if (m < MIN_LINKS || efConstruction < 1 || vectors.empty())
+    {
+        return BUILD_FAIL;
+    }
+    _dims = vectors[0]->size();
+    _m = m;
+    _efConstruction = std::max(efConstruction, m);
+    if (_ef == 0)
+    {
+        _ef = _efConstruction;
+    }
+    _vectors.assign(vectors.size() * _dims, 0.0);
+    for (size_t i = 0; i < vectors.size(); i++)
+    {
+        double *row = &_vectors[i * _dims];
+        std::copy(vectors[i]->begin(), vectors[i]->end(), row);
+        double norm = std::sqrt(VectorMath::dotProd(row, row, _dims));
+        for (size_t j = 0; norm != 0.0 && j < _dims; j++)
+        {
+            row[j] /= norm;
+        }
+    }
+    _links.assign(vectors.size(), std::vector<std::vector<node_t> >());
+    _maxLevel = -1;
+    _gen.seed(LEVELS_SEED);
+    for (node_t node = 0; node < vectors.size(); node++)
+    {
+        _insert(node);
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool HnswIndex::isBuilt() const
+{
+    return _maxLevel >= 0;
+}
+
+/**
+ * sets the number of candidates kept while searching, trading latency for recall
+ * @param ef at least 1
+ */
+void HnswIndex::setEf(int ef)
+{
+    _ef = (size_t) std::max(ef, 1);
+}
+
+/**
+ * @param node
+ * @param query normalized query vector
+ * @return the cosine similarity of the node and the query
+ */
+double HnswIndex::_similarity(node_t node, const double *query) const
+{
+    return VectorMath::dotProd(&_vectors[node * _dims], query, _dims);
+}
+
+/**
+ * greedily walks a single level from the given start towards the query
+ * @return the most similar node reached
+ */
+HnswIndex::scoredNode HnswIndex::_greedy(const double *query, scoredNode start, int level) const
+{
+    bool moved = true;
+    while (moved)
+    {
+        moved = false;
+        for (node_t next : _links[start.second][level])
+        {
+            double sim = _similarity(next, query);
+            if (sim > start.first)
+            {
+                start = scoredNode(sim, next);
+                moved = true;
+            }
+        }
+    }
+    return start;
+}
+
+/**
+ * best first search on a single level
+ * @param query normalized query vector
+ * @param entry start node
+ * @param ef number of candidates to keep
+ * @param level
+ * @param allowed which nodes may be returned, all of them when empty. the disallowed nodes
+ * are still walked through.
+ * @return up to ef allowed nodes, most similar first
+ */
+std::vector<HnswIndex::scoredNode>
+HnswIndex::_searchLevel(const double *query, scoredNode entry, size_t ef, int level,
+                        const std::function<bool(size_t)> &allowed) const
+{
+    std::vector<bool> visited(_links.size(), false);
+    // candidates to expand, most similar on top, and the results, least similar on top:
+    std::priority_queue<scoredNode> candidates;
+    std::priority_queue<scoredNode, std::vector<scoredNode>, std::greater<scoredNode> > results;
+    visited[entry.second] = true;
+    candidates.push(entry);
+    if (!allowed || allowed(entry.second))
+    {
+        results.push(entry);
+    }
+    while (!candidates.empty())
+    {
+        scoredNode cur = candidates.top();
+        if (results.size() >= ef && cur.first < results.top().first)
+        { // nothing left can improve the results
+            break;
+        }
+        candidates.pop();
+        for (node_t next : _links[cur.second][level])
+        {
+            if (visited[next])
+            {
+                continue;
+            }
+            visited[next] = true;
+            double sim = _similarity(next, query);
+            if (results.size() < ef || sim > results.top().first)
+            {
+                candidates.emplace(sim, next);
+                if (!allowed || allowed(next))
+                {
+                    results.emplace(sim, next);
+                    if (results.size() > ef)
+                    {
+                        results.pop();
+                    }
+                }
+            }
+        }
+    }
+    std::vector<scoredNode> out(results.size());
+    for (size_t i = out.size(); i > 0; i--)
+    {
+        out[i - 1] = results.top();
+        results.pop();
+    }
+    return out;
+}
+
+/**
+ * picks up to max diverse links out of the candidates, using the neighbor selection heuristic
+ * @param candidates most similar first
+ * @param max
+ * @return the selected nodes
+ */
+std::vector<HnswIndex::node_t> HnswIndex::_selectLinks(const std::vector<scoredNode> &candidates,
+                                                       size_t max) const
+{
+    std::vector<node_t> selected;
+    std::vector<node_t> pruned;
+    for (const scoredNode &cand : candidates)
+    {
+        if (selected.size() >= max)
+        {
+            break;
+        }
+        bool diverse = true;
+        for (node_t sel : selected)
+        { // a candidate closer to a selected link than to the base is reachable through it
+            if (_similarity(cand.second, &_vectors[sel * _dims]) > cand.first)
+            {
+                diverse = false;
+                break;
+            }
+        }
+        (diverse ? selected : pruned).push_back(cand.second);
+    }
+    for (size_t i = 0; i < pruned.size() && selected.size() < max; i++)
+    { // keep the graph dense enough to stay connected
+        selected.push_back(pruned[i]);
+    }
+    return selected;
+}
+
+/**
+ * adds a node to the graph
+ * @param node index of a vector already in _vectors
+ */
+void HnswIndex::_insert(node_t node)
+{
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    int level = (int) std::floor(-std::log(1.0 - dist(_gen)) / std::log((double) _m));
+    _links[node].resize(level + 1);
+    if (_maxLevel < 0)
+    {
+        _entry = node;
+        _maxLevel = level;
+        return;
+    }
+    const double *query = &_vectors[node * _dims];
+    scoredNode cur(_similarity(_entry, query), _entry);
+    for (int l = _maxLevel; l > level; l--)
+    {
+        cur = _greedy(query, cur, l);
+    }
+    for (int l = std::min(level, _maxLevel); l >= 0; l--)
+    {
+        std::vector<scoredNode> found = _searchLevel(query, cur, _efConstruction, l, nullptr);
+        size_t maxLinks = (l == 0) ? 2 * _m : _m;
+        _links[node][l] = _selectLinks(found, _m);
+        for (node_t other : _links[node][l])
+        {
+            std::vector<node_t> &otherLinks = _links[other][l];
+            otherLinks.push_back(node);
+            if (otherLinks.size() > maxLinks)
+            { // too many links, keep the most diverse ones
+                const double *base = &_vectors[other * _dims];
+                std::vector<scoredNode> scored;
+                for (node_t link : otherLinks)
+                {
+                    scored.emplace_back(_similarity(link, base), link);
+                }
+                std::sort(scored.begin(), scored.end(), std::greater<scoredNode>());
+                otherLinks = _selectLinks(scored, maxLinks);
+            }
+        }
+        cur = found[0];
+    }
+    if (level > _maxLevel)
+    {
+        _entry = node;
+        _maxLevel = level;
+    }
+}
+
+/**
+ * finds the indexed vectors with the highest cosine similarity to the query
+ * @param query a vector of the indexed length
+ * @param k number of results
+ * @param allowed which nodes may be returned
+ * @return up to k nodes and their similarity to the query, most similar first
+ */
+std::vector<std::pair<double, size_t> >
+HnswIndex::search(const std::vector<double> &query, size_t k,
+                  const std::function<bool(size_t)> &allowed) const
+{
+    std::vector<std::pair<double, size_t> > out;
+    if (!isBuilt())
+    {
+        return out;
+    }
+    std::vector<double> normalized(query);
+    double norm = std::sqrt(VectorMath::dotProd(normalized.data(), normalized.data(), _dims));
+    for (size_t j = 0; norm != 0.0 && j < _dims; j++)
+    {
+        normalized[j] /= norm;
+    }
+    scoredNode cur(_similarity(_entry, normalized.data()), _entry);
+    for (int l = _maxLevel; l > 0; l--)
+    {
+        cur = _greedy(normalized.data(), cur, l);
+    }
+    for (const scoredNode &found : _searchLevel(normalized.data(), cur, std::max(_ef, k), 0,
+                                                allowed))
+    {
+        if (out.size() == k)
+        {
+            break;
+        }
+        out.emplace_back(found.first, found.second);
+    }
+    return out;
+}
@@ -0,0 +1,100 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_HNSWINDEX_H
+#define EX5_HNSWINDEX_H
+
+#include <vector>
+#include <functional>
+#include <random>
+
+/**
+ * approximate nearest neighbor index over the normalized movie attribute vectors, by cosine
+ * similarity: a hierarchical navigable small world graph (malkov & yashunin). the search keeps
+ * the ef best candidates found so far, so a bigger ef gives better recall for more latency.
+ */
+class HnswIndex
+{
+private:
+    typedef unsigned int node_t;
+    typedef std::pair<double, node_t> scoredNode; // similarity to the query and the node
+    size_t _dims = 0;
+    size_t _m = 0; // max links of a node on the upper levels, the bottom level keeps 2 * _m
+    size_t _efConstruction = 0;
+    size_t _ef = 0; // candidates kept while searching
+    std::vector<double> _vectors; // the normalized vectors, row major
+    std::vector<std::vector<std::vector<node_t> > > _links; // _links[node][level]
+    node_t _entry = 0;
+    int _maxLevel = -1; // level of the entry point, -1 while the index is empty
+    std::mt19937 _gen;
+    /**
+     * @param node
+     * @param query normalized query vector
+     * @return the cosine similarity of the node and the query
+     */
+    double _similarity(node_t node, const double *query) const;
+    /**
+     * greedily walks a single level from the given start towards the query
+     * @return the most similar node reached
+     */
+    scoredNode _greedy(const double *query, scoredNode start, int level) const;
+    /**
+     * best first search on a single level
+     * @param query normalized query vector
+     * @param entry start node
+     * @param ef number of candidates to keep
+     * @param level
+     * @param allowed which nodes may be returned, all of them when empty. the disallowed nodes
+     * are still walked through.
+     * @return up to ef allowed nodes, most similar first
+     */
+    std::vector<scoredNode> _searchLevel(const double *query, scoredNode entry, size_t ef,
+                                         int level,
+                                         const std::function<bool(size_t)> &allowed) const;
+    /**
+     * picks up to max diverse links out of the candidates, using the neighbor selection heuristic
+     * @param candidates most similar first
+     * @param max
+     * @return the selected nodes
+     */
+    std::vector<node_t> _selectLinks(const std::vector<scoredNode> &candidates,
+                                     size_t max) const;
+    /**
+     * adds a node to the graph
+     * @param node index of a vector already in _vectors
+     */
+    void _insert(node_t node);
+public:
+    /**
+     * builds the index
+     * @param vectors the vectors to index, all of the same length, index i is node i
+     * @param m links kept per node, at least 2
+     * @param efConstruction candidates kept while inserting
+     * @return 0 upon success, -1 upon invalid parameters
+     */
+    int build(const std::vector<const std::vector<double> *> &vectors, int m,
+              int efConstruction);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * sets the number of candidates kept while searching, trading latency for recall
+     * @param ef at least 1
+     */
+    void setEf(int ef);
+    /**
+     * finds the indexed vectors with the highest cosine similarity to the query
+     * @param query a vector of the indexed length
+     * @param k number of results
+     * @param allowed which nodes may be returned
+     * @return up to k nodes and their similarity to the query, most similar first
+     */
+    std::vector<std::pair<double, size_t> > search(const std::vector<double> &query, size_t k,
+                                                   const std::function<bool(size_t)> &allowed)
+                                                   const;
+};
+
+
+#endif //EX5_HNSWINDEX_H
@@ -0,0 +1,231 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "MatrixFactorization.h"
+#include "VectorMath.h"
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#define TRAIN_SUCCESS 0
+#define TRAIN_FAIL -1
+#define FACTORS_SEED 5489u
+
+
+/**
+ * trains the model from the clients' ranks
+ * @param ranks the rank vector of each client, in movie order, where 0.0 means not ranked
+ * @param moviesNum number of movies in every rank vector
+ * @param rank length of the latent vectors
+ * @param iterations number of als iterations
+ * @param lambda regularization weight
+ * @param pool the workers to solve with
+ * @return 0 upon success, -1 upon invalid parameters
+ */
+int MatrixFactorization::train(const std::vector<const std::vector<double> *> &ranks,
+                               size_t moviesNum, int rank, int iterations, double lambda,
+                               ThreadPool &pool)
+{
+    if (rank <= 0 || iterations < 0 || lambda < 0.0)
+    {
+        return TRAIN_FAIL;
+    }
+    _rank = rank;
+    _usersNum = ranks.size();
+    _moviesNum = moviesNum;
+    // the ranks, once by client and once by movie:
+    std::vector<size_t> userOffsets(_usersNum + 1, 0);
+    std::vector<size_t> movieOffsets(_moviesNum + 1, 0);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        userOffsets[u + 1] = userOffsets[u];
+        for (size_t m = 0; m < _moviesNum; m++)
+        {
+            if ((*ranks[u])[m] != 0.0)
+            {
+                userOffsets[u + 1]++;
+                movieOffsets[m + 1]++;
+            }
+        }
+    }
+    for (size_t m = 0; m < _moviesNum; m++)
+    {
+        movieOffsets[m + 1] += movieOffsets[m];
+    }
+    std::vector<size_t> userMovies(userOffsets[_usersNum]);
+    std::vector<double> userRanks(userOffsets[_usersNum]);
+    std::vector<size_t> movieUsers(userOffsets[_usersNum]);
+    std::vector<double> movieRanks(userOffsets[_usersNum]);
+    std::vector<size_t> movieFill(movieOffsets.begin(), movieOffsets.end() - 1);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        size_t pos = userOffsets[u];
+        for (size_t m = 0; m < _moviesNum; m++)
+        {
+            double val = (*ranks[u])[m];
+            if (val != 0.0)
+            {
+                userMovies[pos] = m;
+                userRanks[pos++] = val;
+                movieUsers[movieFill[m]] = u;
+                movieRanks[movieFill[m]++] = val;
+            }
+        }
+    }
+    // small random start, so the first solve is well conditioned
+    std::mt19937 gen(FACTORS_SEED);
+    std::uniform_real_distribution<double> dist(0.0, 1.0 / std::sqrt((double) rank));
+    _userFactors.assign(_usersNum * rank, 0.0);
+    _movieFactors.resize(_moviesNum * rank);
+    for (double &elem : _movieFactors)
+    {
+        elem = dist(gen);
+    }
+    for (int it = 0; it < iterations; it++)
+    {
+        _solveSide(userOffsets, userMovies, userRanks, _movieFactors, _userFactors, lambda, pool);
+        _solveSide(movieOffsets, movieUsers, movieRanks, _userFactors, _movieFactors, lambda,
+                   pool);
+    }
+    return TRAIN_SUCCESS;
+}
+
+/**
+ * one half step of als: solves every row of the solved factors while the fixed ones are held
+ * constant, using the ranks of each row given in compressed sparse row form
+ * @param offsets offsets[i]..offsets[i + 1] is the range of row i in ids and ranks
+ * @param ids the column (index into fixed) of each rank
+ * @param ranks the ranks themselves
+ * @param fixed the factors held constant
+ * @param solved the factors to solve for
+ * @param lambda regularization weight, scaled by the number of ranks of each row
+ * @param pool
+ */
+void MatrixFactorization::_solveSide(const std::vector<size_t> &offsets,
+                                     const std::vector<size_t> &ids,
+                                     const std::vector<double> &ranks,
+                                     const std::vector<double> &fixed,
+                                     std::vector<double> &solved, double lambda, ThreadPool &pool)
+{
+    const int r = _rank;
+    // every worker gets its own normal equations, so a solve allocates nothing
+    std::vector<std::vector<double> > gram(pool.size(), std::vector<double>(r * r));
+    std::vector<std::vector<double> > rhs(pool.size(), std::vector<double>(r));
+    pool.parallelFor(0, offsets.size() - 1, [&](size_t row, unsigned int worker)
+    {
+        double *out = &solved[row * r];
+        size_t count = offsets[row + 1] - offsets[row];
+        if (count == 0)
+        {
+            std::fill(out, out + r, 0.0);
+            return;
+        }
+        std::vector<double> &a = gram[worker];
+        std::vector<double> &b = rhs[worker];
+        std::fill(a.begin(), a.end(), 0.0);
+        std::fill(b.begin(), b.end(), 0.0);
+        for (size_t p = offsets[row]; p < offsets[row + 1]; p++)
+        {
+            const double *vec = &fixed[ids[p] * r];
+            for (int i = 0; i < r; i++)
+            { // only the lower triangle is needed by the decomposition
+                VectorMath::axpy(vec[i], vec, &a[i * r], i + 1);
+            }
+            VectorMath::axpy(ranks[p], vec, b.data(), r);
+        }
+        for (int i = 0; i < r; i++)
+        {
+            a[i * r + i] += lambda * count;
+        }
+        _choleskySolve(a, b, r);
+        std::copy(b.begin(), b.end(), out);
+    });
+}
+
+/**
+ * solves the symmetric positive definite system a * x = b in place with a cholesky
+ * decomposition
+ * @param a rank x rank matrix, overwritten by its decomposition
+ * @param b right hand side, overwritten by the solution
+ * @param n the dimension of the system
+ */
+void MatrixFactorization::_choleskySolve(std::vector<double> &a, std::vector<double> &b, int n)
+{
+    for (int j = 0; j < n; j++)
+    {
+        double diag = a[j * n + j] - VectorMath::dotProd(&a[j * n], &a[j * n], j);
+        diag = std::sqrt(std::max(diag, 1e-12));
+        a[j * n + j] = diag;
+        for (int i = j + 1; i < n; i++)
+        {
+            a[i * n + j] = (a[i * n + j] - VectorMath::dotProd(&a[i * n], &a[j * n], j)) / diag;
+        }
+    }
+    for (int i = 0; i < n; i++)
+    { // forward substitution with the lower triangle
+        b[i] = (b[i] - VectorMath::dotProd(&a[i * n], b.data(), i)) / a[i * n + i];
+    }
+    for (int i = n - 1; i >= 0; i--)
+    { // backward substitution with its transpose
+        double sum = b[i];
+        for (int j = i + 1; j < n; j++)
+        {
+            sum -= a[j * n + i] * b[j];
+        }
+        b[i] = sum / a[i * n + i];
+    }
+}
+
+/**
+ * @return true if train was called successfully
+ */
+bool MatrixFactorization::isTrained() const
+{
+    return _rank > 0;
+}
+
+/**
+ * predicts the rank of a client to a movie
+ * @param user index of the client in the ranks given to train
+ * @param movie index of the movie
+ * @return the dot product of the two latent vectors
+ */
+double MatrixFactorization::predict(size_t user, size_t movie) const
+{
+    return VectorMath::dotProd(&_userFactors[user * _rank], &_movieFactors[movie * _rank], _rank);
+}
+
+/**
+ * finds the movies with the highest predicted rank among those the client did not rank
+ * @param user index of the client in the ranks given to train
+ * @param userRanks the client's rank vector, 0.0 means not ranked
+ * @param n number of movies to return
+ * @return indices of up to n movies, from the best prediction to the worst
+ */
+std::vector<size_t> MatrixFactorization::topMovies(size_t user,
+                                                   const std::vector<double> &userRanks,
+                                                   size_t n) const
+{
+    std::vector<std::pair<double, size_t> > scored;
+    for (size_t m = 0; m < _moviesNum; m++)
+    {
+        if (userRanks[m] == 0.0)
+        {
+            scored.emplace_back(predict(user, m), m);
+        }
+    }
+    n = std::min(n, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + n, scored.end(),
+                      [](const std::pair<double, size_t> &lhs, const std::pair<double, size_t> &rhs)
+                      { // best score first, and the earlier movie between equal scores
+                          return lhs.first > rhs.first ||
+                                 (lhs.first == rhs.first && lhs.second < rhs.second);
+                      });
+    std::vector<size_t> out(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = scored[i].second;
+    }
+    return out;
+}
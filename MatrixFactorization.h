@@ -0,0 +1,83 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_MATRIXFACTORIZATION_H
+#define EX5_MATRIXFACTORIZATION_H
+
+#include <vector>
+#include <string>
+#include "ThreadPool.h"
+
+/**
+ * a low rank model of the clients' ranks: every client and every movie get a latent vector of
+ * length rank, and a predicted rank is the dot product of the two. the model is trained with
+ * alternating least squares, solving all the clients (and then all the movies) in parallel.
+ */
+class MatrixFactorization
+{
+private:
+    int _rank = 0; // length of the latent vectors, 0 while the model is not trained
+    size_t _usersNum = 0;
+    size_t _moviesNum = 0;
+    std::vector<double> _userFactors; // _usersNum x _rank, row major
+    std::vector<double> _movieFactors; // _moviesNum x _rank, row major
+    /**
+     * one half step of als: solves every row of the solved factors while the fixed ones are held
+     * constant, using the ranks of each row given in compressed sparse row form
+     * @param offsets offsets[i]..offsets[i + 1] is the range of row i in ids and ranks
+     * @param ids the column (index into fixed) of each rank
+     * @param ranks the ranks themselves
+     * @param fixed the factors held constant
+     * @param solved the factors to solve for
+     * @param lambda regularization weight, scaled by the number of ranks of each row
+     * @param pool
+     */
+    void _solveSide(const std::vector<size_t> &offsets, const std::vector<size_t> &ids,
+                    const std::vector<double> &ranks, const std::vector<double> &fixed,
+                    std::vector<double> &solved, double lambda, ThreadPool &pool);
+    /**
+     * solves the symmetric positive definite system a * x = b in place with a cholesky
+     * decomposition
+     * @param a rank x rank matrix, overwritten by its decomposition
+     * @param b right hand side, overwritten by the solution
+     * @param n the dimension of the system
+     */
+    static void _choleskySolve(std::vector<double> &a, std::vector<double> &b, int n);
+public:
+    /**
+     * trains the model from the clients' ranks
+     * @param ranks the rank vector of each client, in movie order, where 0.0 means not ranked
+     * @param moviesNum number of movies in every rank vector
+     * @param rank length of the latent vectors
+     * @param iterations number of als iterations
+     * @param lambda regularization weight
+     * @param pool the workers to solve with
+     * @return 0 upon success, -1 upon invalid parameters
+     */
+    int train(const std::vector<const std::vector<double> *> &ranks, size_t moviesNum, int rank,
+              int iterations, double lambda, ThreadPool &pool);
+    /**
+     * @return true if train was called successfully
+     */
+    bool isTrained() const;
+    /**
+     * predicts the rank of a client to a movie
+     * @param user index of the client in the ranks given to train
+     * @param movie index of the movie
+     * @return the dot product of the two latent vectors
+     */
+    double predict(size_t user, size_t movie) const;
+    /**
+     * finds the movies with the highest predicted rank among those the client did not rank
+     * @param user index of the client in the ranks given to train
+     * @param userRanks the client's rank vector, 0.0 means not ranked
+     * @param n number of movies to return
+     * @return indices of up to n movies, from the best prediction to the worst
+     */
+    std::vector<size_t> topMovies(size_t user, const std::vector<double> &userRanks,
+                                  size_t n) const;
+};
+
+
+#endif //EX5_MATRIXFACTORIZATION_H
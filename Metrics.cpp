@@ -0,0 +1,373 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "Metrics.h"
+#include <mutex>
+#include <memory>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#define SUB_BITS 5 // 32 sub buckets per power of two
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define BUCKETS ((64 - SUB_BITS + 1) * SUB_BUCKETS) // up to the top bit of a 64 bit latency
+#define NANOS_PER_MICRO 1000.0
+
+#define METRICS_NAME_ENTRY(id, name) name,
+
+namespace
+{
+    const char *const TIMER_NAMES[] = {RECOMMENDER_TIMERS(METRICS_NAME_ENTRY)};
+    const char *const COUNTER_NAMES[] = {RECOMMENDER_COUNTERS(METRICS_NAME_ENTRY)};
+
+    /**
+     * the slots of one thread. only the owner writes them, so the relaxed load and store pairs
+     * below need no read modify write; the atomics only keep the aggregating reads defined.
+     */
+    struct ThreadSlots
+    {
+        std::atomic<uint64_t> buckets[Metrics::TIMERS_NUM][BUCKETS];
+        std::atomic<uint64_t> totals[Metrics::TIMERS_NUM];
+        std::atomic<uint64_t> mins[Metrics::TIMERS_NUM];
+        std::atomic<uint64_t> maxs[Metrics::TIMERS_NUM];
+        std::atomic<uint64_t> counters[Metrics::COUNTERS_NUM];
+
+        /**
+         * zeroes every slot
+         */
+        void clear()
+        {
+            for (auto &timer : buckets)
+            {
+                for (std::atomic<uint64_t> &bucket : timer)
+                {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+            for (int t = 0; t < Metrics::TIMERS_NUM; t++)
+            {
+                totals[t].store(0, std::memory_order_relaxed);
+                mins[t].store(UINT64_MAX, std::memory_order_relaxed);
+                maxs[t].store(0, std::memory_order_relaxed);
+            }
+            for (std::atomic<uint64_t> &counter : counters)
+            {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * every thread's slots. they are never freed, so the records of finished threads still
+     * count, and nothing depends on the order of destruction at exit
+     */
+    struct Registry
+    {
+        std::mutex lock;
+        std::vector<ThreadSlots *> threads;
+    };
+
+    /**
+     * @return the registry
+     */
+    Registry &registry()
+    {
+        static Registry *instance = new Registry();
+        return *instance;
+    }
+
+    /**
+     * @return the slots of the calling thread, registered on first use
+     */
+    ThreadSlots &localSlots()
+    {
+        thread_local ThreadSlots *slots = nullptr;
+        if (slots == nullptr)
+        {
+            slots = new ThreadSlots();
+            slots->clear();
+            Registry &all = registry();
+            std::lock_guard<std::mutex> guard(all.lock);
+            all.threads.push_back(slots);
+        }
+        return *slots;
+    }
+
+    thread_local int methodDepth = 0; // timed public methods running on this thread
+
+    /**
+     * adds to a slot of the owning thread
+     * @param slot
+     * @param amount
+     */
+    void add(std::atomic<uint64_t> &slot, uint64_t amount)
+    {
+        slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @param nanos
+     * @return the histogram bucket of a latency
+     */
+    size_t bucketOf(uint64_t nanos)
+    {
+        if (nanos < SUB_BUCKETS)
+        {
+            return (size_t) nanos;
+        }
+        int top = 63 - __builtin_clzll(nanos);
+        return (size_t) (top - SUB_BITS + 1) * SUB_BUCKETS +
+               (size_t) ((nanos >> (top - SUB_BITS)) & (SUB_BUCKETS - 1));
+    }
+
+    /**
+     * @param bucket
+     * @return the middle of the latencies a bucket holds
+     */
+    uint64_t valueOf(size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+        {
+            return bucket;
+        }
+        int shift = (int) (bucket / SUB_BUCKETS) - 1;
+        uint64_t low = (uint64_t) (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+        return low + (((uint64_t) 1 << shift) >> 1);
+    }
+
+    /**
+     * @param histogram the summed buckets
+     * @param count their total
+     * @param quantile in (0, 1]
+     * @return the latency at the quantile
+     */
+    uint64_t percentile(const std::vector<uint64_t> &histogram, uint64_t count, double quantile)
+    {
+        uint64_t rank = std::max((uint64_t) 1, (uint64_t) (quantile * count + 0.999999));
+        uint64_t seen = 0;
+        for (size_t b = 0; b < histogram.size(); b++)
+        {
+            seen += histogram[b];
+            if (seen >= rank)
+            {
+                return valueOf(b);
+            }
+        }
+        return 0;
+    }
+}
+
+/**
+ * @param timer
+ */
+Metrics::MethodTimer::MethodTimer(Timer timer) : _timer(timer), _outermost(methodDepth++ == 0),
+                                                 _start(std::chrono::steady_clock::now())
+{
+}
+
+/**
+ * records the elapsed time
+ */
+Metrics::MethodTimer::~MethodTimer()
+{
+    methodDepth--;
+    if (_outermost)
+    {
+        record(_timer, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - _start).count());
+    }
+}
+
+/**
+ * records the elapsed time
+ */
+Metrics::PhaseTimer::~PhaseTimer()
+{
+    record(_timer, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _start).count());
+}
+
+/**
+ * @return true if recording is compiled in
+ */
+bool Metrics::enabled()
+{
+#ifdef RECOMMENDER_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * records a latency of the calling thread
+ * @param timer
+ * @param nanos
+ */
+void Metrics::record(Timer timer, uint64_t nanos)
+{
+    ThreadSlots &slots = localSlots();
+    add(slots.buckets[timer][bucketOf(nanos)], 1);
+    add(slots.totals[timer], nanos);
+    if (nanos < slots.mins[timer].load(std::memory_order_relaxed))
+    {
+        slots.mins[timer].store(nanos, std::memory_order_relaxed);
+    }
+    if (nanos > slots.maxs[timer].load(std::memory_order_relaxed))
+    {
+        slots.maxs[timer].store(nanos, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * adds to a counter of the calling thread
+ * @param counter
+ * @param amount
+ */
+void Metrics::count(Counter counter, uint64_t amount)
+{
+    add(localSlots().counters[counter], amount);
+}
+
+/**
+ * @return the latencies of every timer, summed over the threads
+ */
+std::vector<Metrics::TimerSummary> Metrics::timers()
+{
+    Registry &all = registry();
+    std::lock_guard<std::mutex> guard(all.lock);
+    std::vector<TimerSummary> out;
+    std::vector<uint64_t> histogram(BUCKETS);
+    for (int t = 0; t < TIMERS_NUM; t++)
+    {
+        TimerSummary summary = {TIMER_NAMES[t], 0, 0, UINT64_MAX, 0, 0, 0, 0, 0};
+        std::fill(histogram.begin(), histogram.end(), 0);
+        for (ThreadSlots *slots : all.threads)
+        {
+            for (size_t b = 0; b < BUCKETS; b++)
+            {
+                uint64_t hits = slots->buckets[t][b].load(std::memory_order_relaxed);
+                histogram[b] += hits;
+                summary.count += hits;
+            }
+            summary.total += slots->totals[t].load(std::memory_order_relaxed);
+            summary.min = std::min(summary.min, slots->mins[t].load(std::memory_order_relaxed));
+            summary.max = std::max(summary.max, slots->maxs[t].load(std::memory_order_relaxed));
+        }
+        if (summary.count == 0)
+        {
+            summary.min = 0;
+        }
+        else
+        { // the bucket middles are clamped to the exact extremes
+            summary.p50 = std::min(summary.max, std::max(summary.min,
+                                                         percentile(histogram, summary.count,
+                                                                    0.5)));
+            summary.p90 = std::min(summary.max, percentile(histogram, summary.count, 0.9));
+            summary.p99 = std::min(summary.max, percentile(histogram, summary.count, 0.99));
+            summary.p999 = std::min(summary.max, percentile(histogram, summary.count, 0.999));
+        }
+        out.push_back(summary);
+    }
+    return out;
+}
+
+/**
+ * @return the value of every counter, summed over the threads
+ */
+std::vector<Metrics::CounterSummary> Metrics::counters()
+{
+    Registry &all = registry();
+    std::lock_guard<std::mutex> guard(all.lock);
+    std::vector<CounterSummary> out;
+    for (int c = 0; c < COUNTERS_NUM; c++)
+    {
+        CounterSummary summary = {COUNTER_NAMES[c], 0};
+        for (ThreadSlots *slots : all.threads)
+        {
+            summary.value += slots->counters[c].load(std::memory_order_relaxed);
+        }
+        out.push_back(summary);
+    }
+    return out;
+}
+
+/**
+ * clears the histograms and counters of every thread
+ */
+void Metrics::reset()
+{
+    Registry &all = registry();
+    std::lock_guard<std::mutex> guard(all.lock);
+    for (ThreadSlots *slots : all.threads)
+    {
+        slots->clear();
+    }
+}
+
+/**
+ * @return the timers with a count and the counters as an aligned table, in microseconds
+ */
+std::string Metrics::toText()
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << std::left << std::setw(28) << "timer" << std::right << std::setw(10) << "count";
+    for (const char *column : {"mean us", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us"})
+    {
+        out << std::setw(12) << column;
+    }
+    out << '\n';
+    for (const TimerSummary &summary : timers())
+    {
+        if (summary.count == 0)
+        {
+            continue;
+        }
+        out << std::left << std::setw(28) << summary.name << std::right << std::setw(10)
+            << summary.count;
+        for (double nanos : {(double) summary.total / summary.count, (double) summary.p50,
+                             (double) summary.p90, (double) summary.p99, (double) summary.p999,
+                             (double) summary.max})
+        {
+            out << std::setw(12) << nanos / NANOS_PER_MICRO;
+        }
+        out << '\n';
+    }
+    for (const CounterSummary &summary : counters())
+    {
+        out << std::left << std::setw(48) << summary.name << std::right << std::setw(14)
+            << summary.value << '\n';
+    }
+    return out.str();
+}
+
+/**
+ * @return the timers and counters as a json object, in nanoseconds
+ */
+std::string Metrics::toJson()
+{
+    std::ostringstream out;
+    out << "{\"enabled\": " << (enabled() ? "true" : "false") << ", \"timers\": [";
+    bool first = true;
+    for (const TimerSummary &summary : timers())
+    {
+        out << (first ? "" : ", ") << "{\"name\": \"" << summary.name << "\", \"count\": "
+            << summary.count << ", \"total_ns\": " << summary.total << ", \"min_ns\": "
+            << summary.min << ", \"p50_ns\": " << summary.p50 << ", \"p90_ns\": " << summary.p90
+            << ", \"p99_ns\": " << summary.p99 << ", \"p999_ns\": " << summary.p999
+            << ", \"max_ns\": " << summary.max << "}";
+        first = false;
+    }
+    out << "], \"counters\": [";
+    first = true;
+    for (const CounterSummary &summary : counters())
+    {
+        out << (first ? "" : ", ") << "{\"name\": \"" << summary.name << "\", \"value\": "
+            << summary.value << "}";
+        first = false;
+    }
+    out << "]}";
+    return out.str();
+}
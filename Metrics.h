@@ -0,0 +1,188 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_METRICS_H
+#define EX5_METRICS_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * the timed public methods and internal phases, as X(id, name)
+ */
+#define RECOMMENDER_TIMERS(X) \
+    X(LOAD_DATA, "loadData") \
+    X(LOAD_SNAPSHOT, "loadSnapshot") \
+    X(RECOMMEND_BY_CONTENT, "recommendByContent") \
+    X(PREDICT_MOVIE_SCORE, "predictMovieScoreForUser") \
+    X(RECOMMEND_BY_CF, "recommendByCF") \
+    X(RECOMMEND_HYBRID, "recommendHybrid") \
+    X(TOP_USERS_FOR_MOVIE, "topUsersForMovie") \
+    X(NORM_RANK_VEC, "_getNormRankVec") \
+    X(CREATE_PREF_VEC, "_createPrefVec") \
+    X(FIND_MOVIE_BY_PREF, "_findMovieByPref") \
+    X(FIND_MOVIE_BY_HISTORY, "_findMovieByHistory")
+
+/**
+ * the counted events, as X(id, name)
+ */
+#define RECOMMENDER_COUNTERS(X) \
+    X(MOVIES_SCORED, "movies scored by _findMovieByPref") \
+    X(HISTORY_SORTED, "ranked movies sorted by _findMovieByHistory") \
+    X(LIST_PREDICTIONS, "predictions answered by the neighbor lists")
+
+#define METRICS_ENUM_ENTRY(id, name) id,
+
+/**
+ * per thread latency histograms and counters of the recommender. every thread records into its
+ * own slots with plain relaxed stores, so recording takes no lock and shares no cache line;
+ * summary() and the reports add the slots of every thread up on demand.
+ *
+ * the histograms are hdr style: exact below 32 ns, and above it 32 linear sub buckets per power
+ * of two, so every recorded latency is kept within 3% over the whole range of 64 bit
+ * nanoseconds, in a fixed amount of memory.
+ *
+ * recording is compiled in only with RECOMMENDER_METRICS defined (the cmake option of the same
+ * name). without it the RECOMMENDER_TIME_* and RECOMMENDER_COUNT macros expand to nothing and
+ * the reports are empty.
+ */
+class Metrics
+{
+public:
+    /**
+     * the timers
+     */
+    enum Timer
+    {
+        RECOMMENDER_TIMERS(METRICS_ENUM_ENTRY)
+        TIMERS_NUM
+    };
+    /**
+     * the counters
+     */
+    enum Counter
+    {
+        RECOMMENDER_COUNTERS(METRICS_ENUM_ENTRY)
+        COUNTERS_NUM
+    };
+    /**
+     * the aggregated latencies of one timer, in nanoseconds
+     */
+    struct TimerSummary
+    {
+        std::string name;
+        uint64_t count;
+        uint64_t total;
+        uint64_t min;
+        uint64_t max;
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t p999;
+    };
+    /**
+     * the aggregated value of one counter
+     */
+    struct CounterSummary
+    {
+        std::string name;
+        uint64_t value;
+    };
+    /**
+     * times a public method. calls made from inside another timed public method are not
+     * recorded, so recommendByCF does not count once more for every prediction it makes.
+     */
+    class MethodTimer
+    {
+    private:
+        Timer _timer;
+        bool _outermost;
+        std::chrono::steady_clock::time_point _start;
+    public:
+        /**
+         * @param timer
+         */
+        explicit MethodTimer(Timer timer);
+        /**
+         * records the elapsed time
+         */
+        ~MethodTimer();
+    };
+    /**
+     * times an internal phase, always recorded
+     */
+    class PhaseTimer
+    {
+    private:
+        Timer _timer;
+        std::chrono::steady_clock::time_point _start;
+    public:
+        /**
+         * @param timer
+         */
+        explicit PhaseTimer(Timer timer) : _timer(timer), _start(std::chrono::steady_clock::now())
+        {
+        }
+        /**
+         * records the elapsed time
+         */
+        ~PhaseTimer();
+    };
+    /**
+     * @return true if recording is compiled in
+     */
+    static bool enabled();
+    /**
+     * records a latency of the calling thread
+     * @param timer
+     * @param nanos
+     */
+    static void record(Timer timer, uint64_t nanos);
+    /**
+     * adds to a counter of the calling thread
+     * @param counter
+     * @param amount
+     */
+    static void count(Counter counter, uint64_t amount);
+    /**
+     * @return the latencies of every timer, summed over the threads
+     */
+    static std::vector<TimerSummary> timers();
+    /**
+     * @return the value of every counter, summed over the threads
+     */
+    static std::vector<CounterSummary> counters();
+    /**
+     * clears the histograms and counters of every thread
+     */
+    static void reset();
+    /**
+     * @return the timers with a count and the counters as an aligned table, in microseconds
+     */
+    static std::string toText();
+    /**
+     * @return the timers and counters as a json object, in nanoseconds
+     */
+    static std::string toJson();
+};
+
+#ifdef RECOMMENDER_METRICS
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+#define RECOMMENDER_TIME_METHOD(timer) \
+    Metrics::MethodTimer METRICS_CONCAT(metricsTimer, __LINE__)(Metrics::timer)
+#define RECOMMENDER_TIME_PHASE(timer) \
+    Metrics::PhaseTimer METRICS_CONCAT(metricsTimer, __LINE__)(Metrics::timer)
+#define RECOMMENDER_COUNT(counter, amount) Metrics::count(Metrics::counter, amount)
+#else
+#define RECOMMENDER_TIME_METHOD(timer) do {} while (false)
+#define RECOMMENDER_TIME_PHASE(timer) do {} while (false)
+#define RECOMMENDER_COUNT(counter, amount) do {} while (false)
+#endif
+
+
+#endif //EX5_METRICS_H
@@ -0,0 +1,176 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "MovieClusters.h"
+#include "VectorMath.h"
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define CLUSTERS_SEED 7u
+#define MAX_ITERATIONS 25
+#define BOUND_SLACK 1e-9 // bounds are computed on normalized vectors, the scores are not
+// acos of a cosine off by d near +-1 is off by up to sqrt(2 * d) rad; the dot products of a few
+// hundred attributes are off by d ~ 1e-14, so every bound angle is widened by this much
+#define ANGLE_MARGIN 1e-6
+
+
+/**
+ * @param a
+ * @param b
+ * @return the cosine similarity of two vectors of length _dims, 0 if one of them is zero
+ */
+double MovieClusters::_cosine(const double *a, const double *b) const
+{
+    double norms = std::sqrt(VectorMath::dotProd(a, a, _dims) *
+                             VectorMath::dotProd(b, b, _dims));
+    return (norms == 0.0) ? 0.0 : VectorMath::dotProd(a, b, _dims) / norms;
+}
+
+/**
+ * clusters the vectors
+ * @param vectors the vectors to cluster, all of the same length, index i is movie i
+ * @param clusters number of clusters
+ * @return 0 upon success, -1 upon invalid parameters
+ */
+int MovieClusters::build(const std::vector<const std::vector<double> *> &vectors, int clusters)
+{
+    if (clusters <= 0 || vectors.empty())
+    {
+        return BUILD_FAIL;
+    }
+    _dims = vectors[0]->size();
+    // movies with a zero vector have no cosine with anything, so they are never returned
+    std::vector<size_t> movies;
+    std::vector<double> unit;
+    for (size_t i = 0; i < vectors.size(); i++)
+    {
+        const double *vec = vectors[i]->data();
+        double norm = std::sqrt(VectorMath::dotProd(vec, vec, _dims));
+        if (norm != 0.0)
+        {
+            movies.push_back(i);
+            for (size_t j = 0; j < _dims; j++)
+            {
+                unit.push_back(vec[j] / norm);
+            }
+        }
+    }
+    if (movies.empty())
+    {
+        return BUILD_FAIL;
+    }
+    size_t k = std::min(movies.size(), (size_t) clusters);
+    // k-means++ seeding, by cosine distance
+    std::mt19937 gen(CLUSTERS_SEED);
+    _centroids.assign(k * _dims, 0.0);
+    std::vector<double> distances(movies.size(), 2.0);
+    size_t chosen = std::uniform_int_distribution<size_t>(0, movies.size() - 1)(gen);
+    for (size_t c = 0; c < k; c++)
+    {
+        std::copy(&unit[chosen * _dims], &unit[chosen * _dims] + _dims, &_centroids[c * _dims]);
+        for (size_t i = 0; i < movies.size(); i++)
+        {
+            distances[i] = std::min(distances[i], 1.0 - _cosine(&unit[i * _dims],
+                                                                &_centroids[c * _dims]));
+        }
+        if (std::accumulate(distances.begin(), distances.end(), 0.0) == 0.0)
+        { // every movie already sits on a centroid
+            k = c + 1;
+            _centroids.resize(k * _dims);
+            break;
+        }
+        std::discrete_distribution<size_t> pick(distances.begin(), distances.end());
+        chosen = pick(gen);
+    }
+    // spherical k-means iterations
+    std::vector<size_t> assignment(movies.size(), k);
+    for (int it = 0; it < MAX_ITERATIONS; it++)
+    {
+        bool changed = false;
+        for (size_t i = 0; i < movies.size(); i++)
+        {
+            size_t closest = 0;
+            double closestSim = -2.0;
+            for (size_t c = 0; c < k; c++)
+            {
+                double sim = VectorMath::dotProd(&unit[i * _dims], &_centroids[c * _dims],
+                                                 _dims);
+                if (sim > closestSim)
+                {
+                    closestSim = sim;
+                    closest = c;
+                }
+            }
+            changed |= (assignment[i] != closest);
+            assignment[i] = closest;
+        }
+        if (!changed)
+        {
+            break;
+        }
+        std::vector<double> sums(k * _dims, 0.0);
+        for (size_t i = 0; i < movies.size(); i++)
+        {
+            VectorMath::axpy(1.0, &unit[i * _dims], &sums[assignment[i] * _dims], _dims);
+        }
+        for (size_t c = 0; c < k; c++)
+        {
+            double *sum = &sums[c * _dims];
+            double norm = std::sqrt(VectorMath::dotProd(sum, sum, _dims));
+            if (norm != 0.0)
+            { // an empty cluster keeps its previous centroid
+                for (size_t j = 0; j < _dims; j++)
+                {
+                    _centroids[c * _dims + j] = sum[j] / norm;
+                }
+            }
+        }
+    }
+    _members.assign(k, std::vector<size_t>());
+    _radii.assign(k, 0.0);
+    for (size_t i = 0; i < movies.size(); i++)
+    {
+        size_t c = assignment[i];
+        double sim = VectorMath::dotProd(&unit[i * _dims], &_centroids[c * _dims], _dims);
+        _radii[c] = std::max(_radii[c], std::acos(std::max(-1.0, std::min(1.0, sim))));
+        _members[c].push_back(movies[i]);
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool MovieClusters::isBuilt() const
+{
+    return !_members.empty();
+}
+
+/**
+ * the best cosine any member of each cluster can reach, from the triangle inequality on angles,
+ * already loosened by the rounding error of the bound
+ * @param query a vector of the clustered length, not zero
+ * @param bounds output, pairs of bound and cluster, from the highest bound to the lowest
+ */
+void MovieClusters::_bounds(const double *query,
+                            ArenaVector<std::pair<double, size_t> > &bounds) const
+{
+    // the radius is widened by the rounding error of the two angles, so a tight cluster is never
+    // bounded below its best member
+    bounds.clear();
+    bounds.reserve(_members.size());
+    for (size_t c = 0; c < _members.size(); c++)
+    {
+        double angle = std::acos(std::max(-1.0, std::min(1.0, _cosine(query,
+                                                                      &_centroids[c * _dims]))));
+        bounds.emplace_back(std::cos(std::max(0.0, angle - (_radii[c] + ANGLE_MARGIN))) +
+                            BOUND_SLACK, c);
+    }
+    std::sort(bounds.begin(), bounds.end(), std::greater<std::pair<double, size_t> >());
+}
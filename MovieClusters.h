@@ -0,0 +1,116 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_MOVIECLUSTERS_H
+#define EX5_MOVIECLUSTERS_H
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include "QueryArena.h"
+
+/**
+ * exact pruned search by cosine similarity: the normalized movie vectors are grouped with
+ * spherical k-means, and every cluster keeps its centroid direction and its angular radius
+ * (the widest angle between the centroid and a member). no member of a cluster can be closer to
+ * the query than the angle to the centroid minus the radius, so a cluster whose bound cannot
+ * beat the best movie found so far is skipped without scoring its members.
+ */
+class MovieClusters
+{
+private:
+    size_t _dims = 0;
+    std::vector<double> _centroids; // unit centroid of each cluster, row major
+    std::vector<double> _radii; // angular radius of each cluster
+    std::vector<std::vector<size_t> > _members; // the movies of each cluster, in index order
+    /**
+     * @param a
+     * @param b
+     * @return the cosine similarity of two vectors of length _dims, 0 if one of them is zero
+     */
+    double _cosine(const double *a, const double *b) const;
+    /**
+     * the best cosine any member of each cluster can reach, from the triangle inequality on
+     * angles, already loosened by the rounding error of the bound
+     * @param query a vector of the clustered length, not zero
+     * @param bounds output, pairs of bound and cluster, from the highest bound to the lowest
+     */
+    void _bounds(const double *query, ArenaVector<std::pair<double, size_t> > &bounds) const;
+public:
+    /**
+     * clusters the vectors
+     * @param vectors the vectors to cluster, all of the same length, index i is movie i
+     * @param clusters number of clusters
+     * @return 0 upon success, -1 upon invalid parameters
+     */
+    int build(const std::vector<const std::vector<double> *> &vectors, int clusters);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * finds the allowed movie with the highest score, visiting the clusters from the most
+     * promising one and stopping when the bound of the rest is below the best score. the
+     * bounds are kept in the arena of the calling thread, so the caller holds an ArenaScope.
+     * @tparam Allowed callable taking a movie index, returning true if it may be returned
+     * @tparam Score callable taking a movie index, returning its exact score, the cosine
+     * similarity to the query
+     * @param query a vector of the clustered length, not zero
+     * @param allowed which movies may be returned
+     * @param score the exact score of a movie
+     * @param best output, the index of the best movie, the lowest index between equal scores;
+     * left as it was if no movie is allowed
+     * @return the score of the best movie, -2 if no movie is allowed
+     */
+    template<class Allowed, class Score>
+    double search(const double *query, Allowed allowed, Score score, size_t &best) const;
+};
+
+/**
+ * finds the allowed movie with the highest score, visiting the clusters from the most
+ * promising one and stopping when the bound of the rest is below the best score. the
+ * bounds are kept in the arena of the calling thread, so the caller holds an ArenaScope.
+ * @tparam Allowed callable taking a movie index, returning true if it may be returned
+ * @tparam Score callable taking a movie index, returning its exact score, the cosine similarity
+ * to the query
+ * @param query a vector of the clustered length, not zero
+ * @param allowed which movies may be returned
+ * @param score the exact score of a movie
+ * @param best output, the index of the best movie, the lowest index between equal scores; left
+ * as it was if no movie is allowed
+ * @return the score of the best movie, -2 if no movie is allowed
+ */
+template<class Allowed, class Score>
+double MovieClusters::search(const double *query, Allowed allowed, Score score,
+                             size_t &best) const
+{
+    ArenaVector<std::pair<double, size_t> > bounds;
+    _bounds(query, bounds);
+    double bestScore = -2.0; // below any cosine
+    for (const std::pair<double, size_t> &bound : bounds)
+    {
+        if (bound.first < bestScore)
+        { // the bounds are sorted, so no later cluster can do better either
+            break;
+        }
+        for (size_t movie : _members[bound.second])
+        {
+            if (!allowed(movie))
+            {
+                continue;
+            }
+            double curScore = score(movie);
+            if (curScore > bestScore || (curScore == bestScore && movie < best))
+            {
+                bestScore = curScore;
+                best = movie;
+            }
+        }
+    }
+    return bestScore;
+}
+
+
+#endif //EX5_MOVIECLUSTERS_H
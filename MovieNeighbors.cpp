@@ -0,0 +1,118 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "MovieNeighbors.h"
+#include "VectorMath.h"
+#include <algorithm>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+
+
+/**
+ * computes the neighbor lists
+ * @param vectors the attribute vectors, all of the same length, index i is movie i
+ * @param m length of each list
+ * @param pool the workers to build with
+ * @param quantized when given, every pair is first scored with the 8 bit kernel, and only
+ * the 2m best candidates of each movie are scored exactly. the stored similarities stay
+ * exact, but a movie near the cut may be listed instead of a slightly closer one.
+ * @return 0 upon success, -1 upon invalid parameters
+ */
+int MovieNeighbors::build(const std::vector<const std::vector<double> *> &vectors, int m,
+                          ThreadPool &pool, const QuantizedAttributes *quantized)
+{
+    if (m <= 0 || vectors.empty())
+    {
+        return BUILD_FAIL;
+    }
+    size_t moviesNum = vectors.size();
+    size_t dims = vectors[0]->size();
+    size_t keep = std::min(moviesNum, (size_t) m);
+    VectorMath::ExactKernels kernels = VectorMath::exactKernelsFor(dims);
+    std::vector<double> norms(moviesNum);
+    for (size_t i = 0; i < moviesNum; i++)
+    {
+        norms[i] = kernels.norm(vectors[i]->data(), dims);
+    }
+    _offsets.resize(moviesNum + 1);
+    for (size_t i = 0; i <= moviesNum; i++)
+    {
+        _offsets[i] = i * keep;
+    }
+    _neighbors.resize(moviesNum * keep);
+    _sims.resize(moviesNum * keep);
+    size_t shortlist = std::min(moviesNum, 2 * keep);
+    auto closerFirst = [](const std::pair<double, unsigned int> &lhs,
+                          const std::pair<double, unsigned int> &rhs)
+    {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    };
+    std::vector<std::vector<std::pair<double, unsigned int> > > scratch(pool.size());
+    pool.parallelFor(0, moviesNum, [&](size_t i, unsigned int worker)
+    {
+        std::vector<std::pair<double, unsigned int> > &scored = scratch[worker];
+        scored.clear();
+        for (size_t j = 0; j < moviesNum; j++)
+        {
+            scored.emplace_back(quantized ? quantized->cosine(i, j) : 0.0, (unsigned int) j);
+        }
+        if (quantized)
+        { // only the shortlist gets the exact score
+            std::partial_sort(scored.begin(), scored.begin() + shortlist, scored.end(),
+                              closerFirst);
+            scored.resize(shortlist);
+        }
+        for (std::pair<double, unsigned int> &cur : scored)
+        { // the same expression as _findMovieByHistory, so the sums come out the same
+            size_t j = cur.second;
+            cur.first = kernels.dotProd(vectors[i]->data(), vectors[j]->data(), dims) /
+                        (norms[j] * norms[i]);
+        }
+        std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(), closerFirst);
+        for (size_t p = 0; p < keep; p++)
+        {
+            _sims[i * keep + p] = scored[p].first;
+            _neighbors[i * keep + p] = scored[p].second;
+        }
+    });
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool MovieNeighbors::isBuilt() const
+{
+    return !_offsets.empty();
+}
+
+/**
+ * the similarity weighted average of the client's ranks of the k most similar movies they
+ * ranked
+ * @param movie the predicted movie
+ * @param userRanks the client's rank vector, 0.0 means not ranked
+ * @param k
+ * @param prediction output, the prediction if found
+ * @return true if the list of the movie holds at least k movies the client ranked
+ */
+bool MovieNeighbors::predict(size_t movie, const std::vector<double> &userRanks, int k,
+                             double &prediction) const
+{
+    double numerator = 0.0;
+    double denominator = 0.0;
+    int found = 0;
+    for (size_t p = _offsets[movie]; p < _offsets[movie + 1] && found < k; p++)
+    {
+        double rank = userRanks[_neighbors[p]];
+        if (rank != 0.0)
+        {
+            numerator += _sims[p] * rank;
+            denominator += _sims[p];
+            found++;
+        }
+    }
+    prediction = numerator / denominator;
+    return found == k;
+}
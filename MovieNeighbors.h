@@ -0,0 +1,54 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_MOVIENEIGHBORS_H
+#define EX5_MOVIENEIGHBORS_H
+
+#include <vector>
+#include "ThreadPool.h"
+#include "QuantizedAttributes.h"
+
+/**
+ * for every movie, the m movies most similar to it by attribute cosine (itself included), from
+ * the most similar to the least. a prediction walks the list of the predicted movie and picks
+ * the first k movies the client ranked, instead of sorting the client's whole history.
+ */
+class MovieNeighbors
+{
+private:
+    std::vector<size_t> _offsets; // range of each movie in _neighbors and _sims
+    std::vector<unsigned int> _neighbors;
+    std::vector<double> _sims; // the same values predictMovieScoreForUser computes
+public:
+    /**
+     * computes the neighbor lists
+     * @param vectors the attribute vectors, all of the same length, index i is movie i
+     * @param m length of each list
+     * @param pool the workers to build with
+     * @param quantized when given, every pair is first scored with the 8 bit kernel, and only
+     * the 2m best candidates of each movie are scored exactly. the stored similarities stay
+     * exact, but a movie near the cut may be listed instead of a slightly closer one.
+     * @return 0 upon success, -1 upon invalid parameters
+     */
+    int build(const std::vector<const std::vector<double> *> &vectors, int m, ThreadPool &pool,
+              const QuantizedAttributes *quantized = nullptr);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * the similarity weighted average of the client's ranks of the k most similar movies they
+     * ranked
+     * @param movie the predicted movie
+     * @param userRanks the client's rank vector, 0.0 means not ranked
+     * @param k
+     * @param prediction output, the prediction if found
+     * @return true if the list of the movie holds at least k movies the client ranked
+     */
+    bool predict(size_t movie, const std::vector<double> &userRanks, int k,
+                 double &prediction) const;
+};
+
+
+#endif //EX5_MOVIENEIGHBORS_H
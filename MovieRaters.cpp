@@ -0,0 +1,129 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "MovieRaters.h"
+#include <algorithm>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define USERS_PER_BLOCK 64
+
+
+/**
+ * builds the movie major copy
+ * @param ranks the rank vector of each client, in movie order, where 0.0 means not ranked
+ * @param moviesNum number of movies in every rank vector
+ * @return 0 upon success, -1 when there are no movies
+ */
+int MovieRaters::build(const std::vector<const std::vector<double> *> &ranks, size_t moviesNum)
+{
+    if (moviesNum == 0)
+    {
+        return BUILD_FAIL;
+    }
+    _usersNum = ranks.size();
+    _offsets.assign(moviesNum + 1, 0);
+    _ranked.assign(_usersNum, 0);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        for (size_t m = 0; m < moviesNum; m++)
+        {
+            _offsets[m + 1] += ((*ranks[u])[m] != 0.0);
+            _ranked[u] += ((*ranks[u])[m] != 0.0);
+        }
+    }
+    for (size_t m = 0; m < moviesNum; m++)
+    {
+        _offsets[m + 1] += _offsets[m];
+    }
+    // filling by client order keeps the raters of each movie sorted by client index
+    _users.resize(_offsets[moviesNum]);
+    _ranks.resize(_offsets[moviesNum]);
+    std::vector<size_t> fill(_offsets.begin(), _offsets.end() - 1);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        for (size_t m = 0; m < moviesNum; m++)
+        {
+            if ((*ranks[u])[m] != 0.0)
+            {
+                _users[fill[m]] = (unsigned int) u;
+                _ranks[fill[m]++] = (*ranks[u])[m];
+            }
+        }
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool MovieRaters::isBuilt() const
+{
+    return !_offsets.empty();
+}
+
+/**
+ * predicts one movie for every client: the similarity weighted average of the client's
+ * ranks of the k movies they ranked that come first in order. every block of clients stops
+ * walking the movies once each of its clients found all the ranks it will use.
+ * @param movie the predicted movie
+ * @param order the movies from the most similar to the predicted one to the least
+ * @param sims the similarity of every movie to the predicted one, by movie index
+ * @param k
+ * @param pool the workers to predict with, each takes a block of clients
+ * @param predictions output, the prediction of every client. a client who ranked fewer than
+ * k movies is predicted by all of them, and one who ranked none or ranked the predicted movie
+ * gets NaN
+ */
+void MovieRaters::predictAll(size_t movie, const std::vector<unsigned int> &order,
+                             const std::vector<double> &sims, int k, ThreadPool &pool,
+                             std::vector<double> &predictions) const
+{
+    std::vector<double> numerators(_usersNum, 0.0);
+    std::vector<double> denominators(_usersNum, 0.0);
+    std::vector<int> found(_usersNum, 0);
+    // the ranks each client uses: the raters of the movie are not predicted at all, and a
+    // client never finds more than it ranked, so neither may keep its block walking
+    std::vector<int> goals(_usersNum);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        goals[u] = std::min(k, _ranked[u]);
+    }
+    for (size_t r = _offsets[movie]; r < _offsets[movie + 1]; r++)
+    {
+        goals[_users[r]] = 0;
+    }
+    size_t blocks = (_usersNum + USERS_PER_BLOCK - 1) / USERS_PER_BLOCK;
+    pool.parallelFor(0, blocks, [&](size_t block, unsigned int)
+    { // every block owns its clients' sums, so the blocks never write the same entry
+        unsigned int first = (unsigned int) (block * USERS_PER_BLOCK);
+        unsigned int last = (unsigned int) std::min(_usersNum, (block + 1) * USERS_PER_BLOCK);
+        size_t pending = 0;
+        for (unsigned int u = first; u < last; u++)
+        {
+            pending += (goals[u] != 0);
+        }
+        for (size_t p = 0; p < order.size() && pending != 0; p++)
+        {
+            size_t ranked = order[p];
+            auto begin = _users.begin() + _offsets[ranked];
+            auto end = _users.begin() + _offsets[ranked + 1];
+            for (auto it = std::lower_bound(begin, end, first); it != end && *it < last; ++it)
+            {
+                unsigned int u = *it;
+                if (found[u] < goals[u])
+                {
+                    numerators[u] += sims[ranked] * _ranks[it - _users.begin()];
+                    denominators[u] += sims[ranked];
+                    pending -= (++found[u] == goals[u]);
+                }
+            }
+        }
+    });
+    predictions.resize(_usersNum);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        predictions[u] = numerators[u] / denominators[u];
+    }
+}
@@ -0,0 +1,56 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_MOVIERATERS_H
+#define EX5_MOVIERATERS_H
+
+#include <vector>
+#include "ThreadPool.h"
+
+/**
+ * a movie major copy of the ranks: for every movie, the clients who ranked it and their ranks,
+ * sorted by client. it turns the item based prediction of one movie for every client into a
+ * single walk over the movies, from the most similar to the predicted one to the least, which
+ * hands every rank to its client until each client has found its k movies.
+ */
+class MovieRaters
+{
+private:
+    size_t _usersNum = 0;
+    std::vector<size_t> _offsets; // range of each movie in _users and _ranks
+    std::vector<unsigned int> _users; // the clients who ranked each movie, by index
+    std::vector<double> _ranks; // their ranks of that movie
+    std::vector<int> _ranked; // number of movies each client ranked
+public:
+    /**
+     * builds the movie major copy
+     * @param ranks the rank vector of each client, in movie order, where 0.0 means not ranked
+     * @param moviesNum number of movies in every rank vector
+     * @return 0 upon success, -1 when there are no movies
+     */
+    int build(const std::vector<const std::vector<double> *> &ranks, size_t moviesNum);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * predicts one movie for every client: the similarity weighted average of the client's
+     * ranks of the k movies they ranked that come first in order. every block of clients stops
+     * walking the movies once each of its clients found all the ranks it will use.
+     * @param movie the predicted movie
+     * @param order the movies from the most similar to the predicted one to the least
+     * @param sims the similarity of every movie to the predicted one, by movie index
+     * @param k
+     * @param pool the workers to predict with, each takes a block of clients
+     * @param predictions output, the prediction of every client. a client who ranked fewer than
+     * k movies is predicted by all of them, and one who ranked none or ranked the predicted
+     * movie gets NaN
+     */
+    void predictAll(size_t movie, const std::vector<unsigned int> &order,
+                    const std::vector<double> &sims, int k, ThreadPool &pool,
+                    std::vector<double> &predictions) const;
+};
+
+
+#endif //EX5_MOVIERATERS_H
@@ -0,0 +1,149 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "PerfCounters.h"
+#include <cstring>
+#include <cerrno>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define NO_FD -1
+
+namespace
+{
+    const char *const EVENT_NAMES[] = {"cycles", "instructions", "cache misses",
+                                       "branch misses"};
+}
+
+/**
+ * opens the counters of the calling thread, stopped
+ */
+PerfCounters::PerfCounters()
+{
+#if defined(__linux__)
+    const uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int e = 0; e < EVENTS_NUM; e++)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // allowed at perf_event_paranoid 2, the common default
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        _fds[e] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (_fds[e] == NO_FD && _error.empty())
+        {
+            _error = std::string("perf_event_open(") + EVENT_NAMES[e] + "): " +
+                     std::strerror(errno);
+        }
+    }
+#else
+    for (int &fd : _fds)
+    {
+        fd = NO_FD;
+    }
+    _error = "perf events are only available on linux";
+#endif
+}
+
+/**
+ * closes the counters
+ */
+PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+    for (int fd : _fds)
+    {
+        if (fd != NO_FD)
+        {
+            close(fd);
+        }
+    }
+#endif
+}
+
+/**
+ * @return true if at least one of the events could be opened
+ */
+bool PerfCounters::available() const
+{
+    for (int fd : _fds)
+    {
+        if (fd != NO_FD)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @return why some events could not be opened, empty if all were
+ */
+const std::string &PerfCounters::error() const
+{
+    return _error;
+}
+
+/**
+ * zeroes and starts the counters
+ */
+void PerfCounters::start()
+{
+#if defined(__linux__)
+    for (int fd : _fds)
+    {
+        if (fd != NO_FD)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+/**
+ * stops the counters
+ * @return the counts since start
+ */
+PerfCounters::Sample PerfCounters::stop()
+{
+    Sample sample;
+    for (int e = 0; e < EVENTS_NUM; e++)
+    {
+        sample.values[e] = 0.0;
+        sample.valid[e] = false;
+#if defined(__linux__)
+        if (_fds[e] == NO_FD)
+        {
+            continue;
+        }
+        ioctl(_fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t read[3]; // the value, the time enabled and the time running
+        if (::read(_fds[e], read, sizeof(read)) == (ssize_t) sizeof(read) && read[2] != 0)
+        { // scaled up when the kernel multiplexed the counter with others
+            sample.values[e] = (double) read[0] * ((double) read[1] / (double) read[2]);
+            sample.valid[e] = true;
+        }
+#endif
+    }
+    return sample;
+}
+
+/**
+ * @param event
+ * @return the name of the event
+ */
+const char *PerfCounters::name(Event event)
+{
+    return EVENT_NAMES[event];
+}
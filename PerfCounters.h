@@ -0,0 +1,84 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_PERFCOUNTERS_H
+#define EX5_PERFCOUNTERS_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * the hardware counters of the calling thread around a piece of code, read with linux's
+ * perf_event_open: cycles, instructions, cache misses (last level) and branch misses. every
+ * event is opened on its own, so a cpu or a virtual machine that lacks some of them still
+ * reports the rest, and a counter the kernel multiplexed is scaled up to the time it was
+ * enabled. the work the code hands to other threads, such as the recommender's workers, is not
+ * counted.
+ *
+ * where perf events are not available at all (another os, a container, or
+ * /proc/sys/kernel/perf_event_paranoid too high) nothing fails: available() is false, error()
+ * says why, and the samples come back marked invalid.
+ */
+class PerfCounters
+{
+public:
+    /**
+     * the counted events
+     */
+    enum Event
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        EVENTS_NUM
+    };
+    /**
+     * the counts of one measured interval
+     */
+    struct Sample
+    {
+        double values[EVENTS_NUM];
+        bool valid[EVENTS_NUM]; // false for the events that could not be opened or read
+    };
+private:
+    int _fds[EVENTS_NUM];
+    std::string _error;
+public:
+    /**
+     * opens the counters of the calling thread, stopped
+     */
+    PerfCounters();
+    /**
+     * closes the counters
+     */
+    ~PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    /**
+     * @return true if at least one of the events could be opened
+     */
+    bool available() const;
+    /**
+     * @return why some events could not be opened, empty if all were
+     */
+    const std::string &error() const;
+    /**
+     * zeroes and starts the counters
+     */
+    void start();
+    /**
+     * stops the counters
+     * @return the counts since start
+     */
+    Sample stop();
+    /**
+     * @param event
+     * @return the name of the event
+     */
+    static const char *name(Event event);
+};
+
+
+#endif //EX5_PERFCOUNTERS_H
@@ -0,0 +1,163 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "QuantizedAttributes.h"
+#include <cmath>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define MAX_VALUE 127.0 // keeps the pairwise sums of pmaddubsw within int16
+#define LANES 32 // bytes in an avx2 register
+
+
+/**
+ * quantizes the vectors
+ * @param vectors the vectors to quantize, all of the same length, index i is movie i
+ * @return 0 upon success, -1 if a vector holds a negative attribute
+ */
+int QuantizedAttributes::build(const std::vector<const std::vector<double> *> &vectors)
+{
+    if (vectors.empty())
+    {
+        return BUILD_FAIL;
+    }
+    _dims = vectors[0]->size();
+    _stride = (_dims + LANES - 1) / LANES * LANES;
+    _values.assign(vectors.size() * _stride, 0);
+    _scales.assign(vectors.size(), 0.0);
+    _norms.assign(vectors.size(), 0.0);
+    for (size_t i = 0; i < vectors.size(); i++)
+    {
+        const std::vector<double> &vec = *vectors[i];
+        if (std::any_of(vec.begin(), vec.end(), [](double val) { return val < 0.0; }))
+        {
+            _values.clear();
+            return BUILD_FAIL;
+        }
+        double max = vec.empty() ? 0.0 : *std::max_element(vec.begin(), vec.end());
+        bool integral = std::all_of(vec.begin(), vec.end(), [](double val)
+        {
+            return val == std::floor(val);
+        });
+        // integers that fit, like the 1-10 of the movie files, are kept as they are and so exact
+        _scales[i] = (integral && max <= MAX_VALUE) ? 1.0 : max / MAX_VALUE;
+        uint8_t *row = &_values[i * _stride];
+        for (size_t j = 0; j < _dims; j++)
+        {
+            row[j] = (uint8_t) std::lround(vec[j] / _scales[i]);
+        }
+        // the values are at most 127, so the same bytes are also a valid signed vector
+        _norms[i] = std::sqrt((double) dotProd(row, (const int8_t *) row, _stride));
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool QuantizedAttributes::isBuilt() const
+{
+    return !_values.empty();
+}
+
+/**
+ * quantizes a query vector to signed 8 bit, scaled so its largest absolute value is 127
+ * @param vec a vector of the quantized length
+ * @param out output, the quantized vector padded to the stride
+ * @return the norm of the quantized vector, in quantized units
+ */
+double QuantizedAttributes::quantizeQuery(const std::vector<double> &vec,
+                                          std::vector<int8_t> &out) const
+{
+    out.assign(_stride, 0);
+    double max = 0.0;
+    for (double val : vec)
+    {
+        max = std::max(max, std::fabs(val));
+    }
+    double scale = (max == 0.0) ? 1.0 : max / MAX_VALUE;
+    double sum = 0.0;
+    for (size_t j = 0; j < _dims; j++)
+    {
+        out[j] = (int8_t) std::lround(vec[j] / scale);
+        sum += out[j] * out[j];
+    }
+    return std::sqrt(sum);
+}
+
+/**
+ * @param movie
+ * @param query a query quantized by quantizeQuery
+ * @param queryNorm the norm quantizeQuery returned
+ * @return the approximate cosine similarity of the movie and the query
+ */
+double QuantizedAttributes::cosine(size_t movie, const std::vector<int8_t> &query,
+                                   double queryNorm) const
+{ // the scales cancel out of the cosine
+    return dotProd(&_values[movie * _stride], query.data(), _stride) /
+           (_norms[movie] * queryNorm);
+}
+
+/**
+ * @param a first movie
+ * @param b second movie
+ * @return the approximate cosine similarity of the two movies
+ */
+double QuantizedAttributes::cosine(size_t a, size_t b) const
+{
+    return dotProd(&_values[a * _stride], (const int8_t *) &_values[b * _stride], _stride) /
+           (_norms[a] * _norms[b]);
+}
+
+/**
+ * @return the bytes held by the quantized vectors
+ */
+size_t QuantizedAttributes::bytes() const
+{
+    return _values.size() + (_scales.size() + _norms.size()) * sizeof(double);
+}
+
+/**
+ * integer dot product of an unsigned and a signed 8 bit vector
+ * @param a values in [0, 127]
+ * @param b values in [-127, 127]
+ * @param n length of both vectors, a multiple of 32
+ * @return the dot product
+ */
+int32_t QuantizedAttributes::dotProd(const uint8_t *a, const int8_t *b, size_t n)
+{
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+#if !((defined(__AVX512VNNI__) && defined(__AVX512VL__)) || defined(__AVXVNNI__))
+    const __m256i ones = _mm256_set1_epi16(1);
+#endif
+    for (size_t j = 0; j < n; j += LANES)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + j));
+        __m256i vb = _mm256_loadu_si256((const __m256i *) (b + j));
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+        acc = _mm256_dpbusd_epi32(acc, va, vb);
+#elif defined(__AVXVNNI__)
+        acc = _mm256_dpbusd_avx_epi32(acc, va, vb);
+#else // u8 * s8 pairs summed to int16, then pairs of those summed to int32
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(va, vb), ones));
+#endif
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t out = 0;
+    for (size_t j = 0; j < n; j++)
+    {
+        out += (int32_t) a[j] * b[j];
+    }
+    return out;
+#endif
+}
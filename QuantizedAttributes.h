@@ -0,0 +1,73 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_QUANTIZEDATTRIBUTES_H
+#define EX5_QUANTIZEDATTRIBUTES_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * an 8 bit copy of the movie attribute vectors. a vector of integers up to 127 (like the 1-10
+ * of the movie files) is stored as it is, exactly; any other vector is scaled so its largest
+ * attribute becomes 127 and rounded. dot products run on integers, with the avx-vnni /
+ * avx512-vnni dot product instructions or the avx2 pmaddubsw sequence when the build targets
+ * them, and a scalar loop otherwise. the attributes must not be negative; queries may be.
+ */
+class QuantizedAttributes
+{
+private:
+    size_t _dims = 0;
+    size_t _stride = 0; // _dims rounded up to a whole simd register, the padding is zero
+    std::vector<uint8_t> _values; // the quantized vectors, in [0, 127], row major
+    std::vector<double> _scales; // attribute = value * scale
+    std::vector<double> _norms; // norm of each quantized vector, in quantized units
+public:
+    /**
+     * quantizes the vectors
+     * @param vectors the vectors to quantize, all of the same length, index i is movie i
+     * @return 0 upon success, -1 if a vector holds a negative attribute
+     */
+    int build(const std::vector<const std::vector<double> *> &vectors);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * quantizes a query vector to signed 8 bit, scaled so its largest absolute value is 127
+     * @param vec a vector of the quantized length
+     * @param out output, the quantized vector padded to the stride
+     * @return the norm of the quantized vector, in quantized units
+     */
+    double quantizeQuery(const std::vector<double> &vec, std::vector<int8_t> &out) const;
+    /**
+     * @param movie
+     * @param query a query quantized by quantizeQuery
+     * @param queryNorm the norm quantizeQuery returned
+     * @return the approximate cosine similarity of the movie and the query
+     */
+    double cosine(size_t movie, const std::vector<int8_t> &query, double queryNorm) const;
+    /**
+     * @param a first movie
+     * @param b second movie
+     * @return the approximate cosine similarity of the two movies
+     */
+    double cosine(size_t a, size_t b) const;
+    /**
+     * @return the bytes held by the quantized vectors
+     */
+    size_t bytes() const;
+    /**
+     * integer dot product of an unsigned and a signed 8 bit vector
+     * @param a values in [0, 127]
+     * @param b values in [-127, 127]
+     * @param n length of both vectors, a multiple of 32
+     * @return the dot product
+     */
+    static int32_t dotProd(const uint8_t *a, const int8_t *b, size_t n);
+};
+
+
+#endif //EX5_QUANTIZEDATTRIBUTES_H
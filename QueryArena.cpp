@@ -0,0 +1,100 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "QueryArena.h"
+#include <algorithm>
+#include <new>
+
+#define FIRST_BLOCK (64 * 1024) // the bytes of the first block, each new block doubles it
+
+
+/**
+ * frees the blocks
+ */
+QueryArena::~QueryArena()
+{
+    for (Block &block : _blocks)
+    {
+        ::operator delete(block.data);
+    }
+}
+
+/**
+ * @return the arena of the calling thread
+ */
+QueryArena &QueryArena::local()
+{
+    thread_local QueryArena arena;
+    return arena;
+}
+
+/**
+ * @param bytes
+ * @param align a power of two
+ * @return aligned memory valid until the arena is rewound past it
+ */
+void *QueryArena::allocate(size_t bytes, size_t align)
+{
+    while (_block < _blocks.size())
+    {
+        Block &block = _blocks[_block];
+        size_t start = (_used + align - 1) & ~(align - 1);
+        if (start + bytes <= block.size)
+        {
+            _used = start + bytes;
+            return block.data + start;
+        }
+        _block++; // the rest of this block stays unused until a rewind
+        _used = 0;
+    }
+    size_t size = _blocks.empty() ? FIRST_BLOCK : _blocks.back().size * 2;
+    size = std::max(size, bytes);
+    // operator new aligns for any fundamental type, so offsets aligned within a block suffice
+    Block block = {static_cast<char *>(::operator new(size)), size};
+    _blocks.push_back(block);
+    _allocations++;
+    _block = _blocks.size() - 1;
+    _used = bytes;
+    return block.data;
+}
+
+/**
+ * @return the current position
+ */
+QueryArena::Mark QueryArena::mark() const
+{
+    Mark out = {_block, _used};
+    return out;
+}
+
+/**
+ * releases everything allocated since a mark, keeping the blocks
+ * @param to
+ */
+void QueryArena::rewind(Mark to)
+{
+    _block = to.block;
+    _used = to.used;
+}
+
+/**
+ * @return the bytes of the blocks held
+ */
+size_t QueryArena::capacity() const
+{
+    size_t total = 0;
+    for (const Block &block : _blocks)
+    {
+        total += block.size;
+    }
+    return total;
+}
+
+/**
+ * @return how many times the arena grew by a block taken from the heap
+ */
+size_t QueryArena::heapAllocations() const
+{
+    return _allocations;
+}
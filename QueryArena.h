@@ -0,0 +1,146 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_QUERYARENA_H
+#define EX5_QUERYARENA_H
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * a per thread monotonic arena for the temporaries of a query. allocation bumps a pointer
+ * through blocks the arena keeps for the life of the thread, and freeing does nothing; an
+ * ArenaScope instead rewinds the arena to where it stood when the scope was entered. once the
+ * blocks have grown to a query's needs, the queries that follow take no memory from the heap
+ * at all, and threads never meet in the allocator.
+ *
+ * memory taken inside a scope must not be used after the scope ends, so arena containers are
+ * kept to locals of the query methods and never returned through the public api.
+ */
+class QueryArena
+{
+private:
+    struct Block
+    {
+        char *data;
+        size_t size;
+    };
+    std::vector<Block> _blocks;
+    size_t _block = 0; // the block being filled
+    size_t _used = 0; // bytes taken from it
+    size_t _allocations = 0; // blocks ever taken from the heap
+    QueryArena() = default;
+public:
+    /**
+     * a position in the arena
+     */
+    struct Mark
+    {
+        size_t block;
+        size_t used;
+    };
+    /**
+     * frees the blocks
+     */
+    ~QueryArena();
+    QueryArena(const QueryArena &) = delete;
+    QueryArena &operator=(const QueryArena &) = delete;
+    /**
+     * @return the arena of the calling thread
+     */
+    static QueryArena &local();
+    /**
+     * @param bytes
+     * @param align a power of two
+     * @return aligned memory valid until the arena is rewound past it
+     */
+    void *allocate(size_t bytes, size_t align);
+    /**
+     * @return the current position
+     */
+    Mark mark() const;
+    /**
+     * releases everything allocated since a mark, keeping the blocks
+     * @param to
+     */
+    void rewind(Mark to);
+    /**
+     * @return the bytes of the blocks held
+     */
+    size_t capacity() const;
+    /**
+     * @return how many times the arena grew by a block taken from the heap
+     */
+    size_t heapAllocations() const;
+};
+
+/**
+ * the temporaries of a query: everything the calling thread allocates from its arena while the
+ * scope lives is released when it ends
+ */
+class ArenaScope
+{
+private:
+    QueryArena &_arena;
+    QueryArena::Mark _mark;
+public:
+    ArenaScope() : _arena(QueryArena::local()), _mark(_arena.mark())
+    {
+    }
+    ~ArenaScope()
+    {
+        _arena.rewind(_mark);
+    }
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+};
+
+/**
+ * a standard allocator drawing from the calling thread's arena, e.g. for ArenaVector
+ * @tparam T
+ */
+template<class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    ArenaAllocator() = default;
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &)
+    {
+    }
+    /**
+     * @param n
+     * @return memory for n objects of T
+     */
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(QueryArena::local().allocate(n * sizeof(T), alignof(T)));
+    }
+    /**
+     * does nothing, the memory returns when the scope ends
+     */
+    void deallocate(T *, size_t)
+    {
+    }
+    template<class U>
+    bool operator==(const ArenaAllocator<U> &) const
+    {
+        return true;
+    }
+    template<class U>
+    bool operator!=(const ArenaAllocator<U> &) const
+    {
+        return false;
+    }
+};
+
+/**
+ * a vector of query temporaries
+ */
+template<class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+
+#endif //EX5_QUERYARENA_H
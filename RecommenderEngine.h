@@ -0,0 +1,54 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_RECOMMENDERENGINE_H
+#define EX5_RECOMMENDERENGINE_H
+
+#include <string>
+
+/**
+ * the api every implementation of the recommender provides, so the implementations can be run
+ * side by side on the same instructions (see bench/EngineCompare.cpp) and swapped for each
+ * other. the results of the queries follow RecommenderSystem: the invalid user message for an
+ * unknown client, and -1 for an unknown client or movie in predictMovieScoreForUser.
+ */
+class RecommenderEngine
+{
+public:
+    virtual ~RecommenderEngine() = default;
+    /**
+     * @return a short name of the implementation
+     */
+    virtual std::string engineName() const = 0;
+    /**
+     * loads the movie attributes file and the clients rank file
+     * @param moviesAttributesFilePath
+     * @param userRanksFilePath
+     * @return 0 upon success, another value upon failure
+     */
+    virtual int loadData(const std::string &moviesAttributesFilePath,
+                         const std::string &userRanksFilePath) = 0;
+    /**
+     * @param userName client name
+     * @return the movie recommended by the content based algorithm
+     */
+    virtual std::string recommendByContent(const std::string &userName) = 0;
+    /**
+     * @param movieName
+     * @param userName client name
+     * @param k
+     * @return the predicted rank of the client to the movie
+     */
+    virtual double predictMovieScoreForUser(const std::string &movieName,
+                                            const std::string &userName, int k) = 0;
+    /**
+     * @param userName client name
+     * @param k
+     * @return the movie with the highest predicted rank
+     */
+    virtual std::string recommendByCF(const std::string &userName, int k) = 0;
+};
+
+
+#endif //EX5_RECOMMENDERENGINE_H
@@ -7,10 +7,19 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
 
 
 #define LOAD_FAIL -1
 #define LOAD_SUCCESS 0
+#define BUILD_FAIL -1
+#define BUILD_SUCCESS 0
+#define WORD_BITS 64
+#define PARSE_CHUNK_BYTES (1 << 20) // the least bytes of the ranks file parsed by one task
 const std::string OPEN_FAIL = "Unable to open file ";
 const std::string NA = "NA";
 const std::string INVALID_USER = "USER NOT FOUND";
@@ -26,6 +35,14 @@ void printMessage(const std::string &msg, const std::string &path)
     std::cerr << msg << path << std::endl;
 }
 
+/**
+ * @return "reference", the name of this implementation
+ */
+std::string RecommenderSystem::engineName() const
+{
+    return "reference";
+}
+
 /**
  * a function which loads data from movie attributes file and clients rank history
  * @param moviesAttributesFilePath
@@ -35,90 +52,346 @@ void printMessage(const std::string &msg, const std::string &path)
 int RecommenderSystem::loadData(const std::string &moviesAttributesFilePath,
                                 const std::string &userRanksFilePath)
 {
+    RECOMMENDER_TIME_METHOD(LOAD_DATA);
+    RECOMMENDER_TRACE_SPAN("loadData", "load");
     std::ifstream movies(moviesAttributesFilePath);
-    if (movies)
+    if (!movies)
     {
-        std::string line;
-        while (std::getline(movies, line))
-        {
-            std::string movieName;
-            std::istringstream lineStream(line);
-            if (!(lineStream >> movieName))
-            {
-                return LOAD_FAIL;
-            }
-            double val;
-            while (lineStream >> val)
-            {
-                _movies[movieName].push_back(val);
-            }
-        }
+        printMessage(OPEN_FAIL, moviesAttributesFilePath);
+        return LOAD_FAIL;
+    }
+    std::ifstream clients(userRanksFilePath, std::ios::binary);
+    if (!clients)
+    {
+        printMessage(OPEN_FAIL, userRanksFilePath);
+        return LOAD_FAIL;
+    }
+    RECOMMENDER_TRACE_SPAN("parse ranks", "load", userRanksFilePath.c_str());
+    std::string line;
+    std::getline(clients, line);
+    std::istringstream lineStream(line);
+    std::string val;
+    while (lineStream >> val)
+    { // parse first line, which is the line with the movie names
+        _movieIds[val] = _movieNames.size();
+        _movieNames.push_back(val);
+    }
+    // the rest of the file, the client lines, is split into chunks parsed side by side
+    size_t bodyBegin = line.size() + 1;
+    clients.clear();
+    clients.seekg(0, std::ios::end);
+    size_t size = (size_t) clients.tellg();
+    size_t body = (size > bodyBegin) ? size - bodyBegin : 0;
+    std::vector<RanksChunk> chunks(std::max<size_t>(1, body / PARSE_CHUNK_BYTES));
+    int moviesStatus = LOAD_SUCCESS;
+    if (chunks.size() == 1)
+    { // a small file is not worth the workers
+        moviesStatus = _parseMovies(movies);
+        _parseRanksChunk(userRanksFilePath, bodyBegin, size, chunks[0]);
     }
     else
+    { // the movies are parsed by one worker while the others parse the ranks
+        ThreadPool &pool = _threadPool();
+        pool.submit([this, &movies, &moviesStatus]
+        {
+            moviesStatus = _parseMovies(movies);
+        });
+        pool.parallelFor(0, chunks.size(), [&](size_t c, unsigned int)
+        {
+            _parseRanksChunk(userRanksFilePath, bodyBegin + body * c / chunks.size(),
+                             bodyBegin + body * (c + 1) / chunks.size(), chunks[c]);
+        });
+        pool.wait();
+    }
+    if (moviesStatus != LOAD_SUCCESS)
     {
-        printMessage(OPEN_FAIL, moviesAttributesFilePath);
         return LOAD_FAIL;
     }
-    std::ifstream clients(userRanksFilePath);
-    if (clients)
+    for (RanksChunk &chunk : chunks) // in file order
+    {
+        if (_mergeRanksChunk(chunk) != LOAD_SUCCESS)
+        {
+            return LOAD_FAIL;
+        }
+    }
+    return _finishLoad();
+}
+
+/**
+ * helper method, parses the lines of the movie attributes file into _movies
+ * @param movies the open file
+ * @return 0 upon success, -1 upon a line without a movie name
+ */
+int RecommenderSystem::_parseMovies(std::istream &movies)
+{
+    RECOMMENDER_TRACE_SPAN("parse movies", "load");
+    std::string line;
+    while (std::getline(movies, line))
+    {
+        std::string movieName;
+        std::istringstream lineStream(line);
+        if (!(lineStream >> movieName))
+        {
+            return LOAD_FAIL;
+        }
+        double val;
+        while (lineStream >> val)
+        {
+            _movies[movieName].push_back(val);
+        }
+    }
+    return LOAD_SUCCESS;
+}
+
+/**
+ * helper func, finds the next word of a line, the way operator>> splits the line into words
+ * @param cur where to start, set to the end of the word
+ * @param end end of the line
+ * @return the start of the word, or end if there are no more words
+ */
+const char *nextWord(const char *&cur, const char *end)
+{
+    while (cur != end && std::isspace((unsigned char) *cur))
+    {
+        cur++;
+    }
+    const char *word = cur;
+    while (cur != end && !std::isspace((unsigned char) *cur))
+    {
+        cur++;
+    }
+    return word;
+}
+
+/**
+ * helper method, parses the client lines that start in a byte range of the ranks file. the
+ * ranges of the chunks may cut lines anywhere, each line is parsed by the chunk it starts in.
+ * @param path the ranks file
+ * @param begin first byte of the range
+ * @param end the byte after the range
+ * @param chunk output, the parsed lines, up to the first invalid one
+ */
+void RecommenderSystem::_parseRanksChunk(const std::string &path, size_t begin, size_t end,
+                                         RanksChunk &chunk)
+{
+    RECOMMENDER_TRACE_SPAN("parse ranks chunk", "load");
+    std::ifstream file(path, std::ios::binary);
+    if (begin >= end || !file.seekg(begin - 1))
+    {
+        return;
+    }
+    std::string line;
+    if (file.get() != '\n')
+    { // the range starts inside a line, which belongs to the chunk before
+        std::getline(file, line);
+        begin += line.size() + 1;
+    }
+    try
     {
-        std::string line;
-        int i = 0;
-        while (std::getline(clients, line))
+        while (begin < end && std::getline(file, line))
         {
-            std::istringstream lineStream(line);
-            if (i == 0)
-            { // parse first line, which is the line with the movie names
-                std::string val;
-                while (lineStream >> val)
+            begin += line.size() + 1;
+            const char *cur = line.data();
+            const char *lineEnd = cur + line.size();
+            const char *word = nextWord(cur, lineEnd);
+            if (word == lineEnd)
+            {
+                chunk.failed = true;
+                return;
+            }
+            chunk.names.emplace_back(word, cur);
+            chunk.ranks.emplace_back();
+            chunk.ranked.push_back(0);
+            std::vector<double> &ranks = chunk.ranks.back();
+            while ((word = nextWord(cur, lineEnd)) != lineEnd)
+            {
+                if (NA.compare(0, std::string::npos, word, cur - word) == 0)
                 {
-                    _movieNames.push_back(val);
+                    ranks.push_back(0.0);
+                    continue;
                 }
-            }
-            else
-            { // parse the rest of the file line by line (client data)
-                std::string clientName;
-                if (!(lineStream >> clientName))
+                char *parsed;
+                errno = 0;
+                double rank = std::strtod(word, &parsed); // the conversion of std::stod
+                if (parsed == word)
                 {
-                    return LOAD_FAIL;
+                    throw std::invalid_argument("stod");
                 }
-                std::string val;
-                while (lineStream >> val)
+                if (errno == ERANGE)
                 {
-                    _updateUserRank(i, clientName, val);
+                    throw std::out_of_range("stod");
                 }
+                ranks.push_back(rank);
+                chunk.ranked.back()++;
             }
-            i = 1;
         }
     }
-    else
+    catch (...)
+    { // rethrown by _mergeRanksChunk, after the lines before it are merged
+        chunk.error = std::current_exception();
+    }
+}
+
+/**
+ * helper method, adds the parsed client lines of a chunk to the clients, as if the lines
+ * were read one after the other
+ * @param chunk moved from
+ * @return 0 upon success, -1 if the chunk stopped at a line without a client name
+ */
+int RecommenderSystem::_mergeRanksChunk(RanksChunk &chunk)
+{
+    for (size_t l = 0; l < chunk.names.size(); l++)
     {
-        printMessage(OPEN_FAIL, userRanksFilePath);
+        const std::string &clientName = chunk.names[l];
+        if (!_clientIds.count(clientName))
+        {
+            _clientIds[clientName] = _clientNames.size();
+            _clientNames.push_back(clientName);
+        }
+        std::vector<double> &lineRanks = chunk.ranks[l];
+        if (lineRanks.empty())
+        {
+            continue;
+        }
+        std::vector<double> &ranks = _clients[clientName];
+        if (ranks.empty())
+        {
+            ranks.swap(lineRanks);
+        }
+        else
+        { // a client of more than one line
+            ranks.insert(ranks.end(), lineRanks.begin(), lineRanks.end());
+        }
+        if (chunk.ranked[l] != 0)
+        {
+            _clientsRanksNum[clientName] = chunk.ranked[l]; // the number of movies watched
+        }
+    }
+    if (chunk.error)
+    {
+        std::rethrow_exception(chunk.error);
+    }
+    return chunk.failed ? LOAD_FAIL : LOAD_SUCCESS;
+}
+
+/**
+ * loads the movies and clients from a binary snapshot, written by saveSnapshot or the dataset
+ * generator, instead of the text files
+ * @param snapshotFilePath
+ * @return 0 upon success, -1 upon failure
+ */
+int RecommenderSystem::loadSnapshot(const std::string &snapshotFilePath)
+{
+    RECOMMENDER_TIME_METHOD(LOAD_SNAPSHOT);
+    RECOMMENDER_TRACE_SPAN("loadSnapshot", "load", snapshotFilePath.c_str());
+    SnapshotReader reader;
+    std::vector<std::vector<double> > attributes;
+    if (reader.open(snapshotFilePath, _movieNames, attributes) != LOAD_SUCCESS)
+    {
+        printMessage(OPEN_FAIL, snapshotFilePath);
         return LOAD_FAIL;
     }
-    return LOAD_SUCCESS;
+    for (size_t i = 0; i < _movieNames.size(); i++)
+    {
+        _movieIds[_movieNames[i]] = i;
+        _movies[_movieNames[i]].swap(attributes[i]);
+    }
+    std::string clientName;
+    std::vector<double> ranks;
+    int status;
+    while ((status = reader.nextClient(clientName, ranks)) > 0)
+    {
+        if (!_clientIds.count(clientName))
+        {
+            _clientIds[clientName] = _clientNames.size();
+            _clientNames.push_back(clientName);
+        }
+        int ranked = (int) (ranks.size() - std::count(ranks.begin(), ranks.end(), 0.0));
+        if (ranked != 0)
+        {
+            _clientsRanksNum[clientName] = ranked;
+        }
+        _clients[clientName].swap(ranks);
+    }
+    if (status < 0)
+    {
+        printMessage(OPEN_FAIL, snapshotFilePath);
+        return LOAD_FAIL;
+    }
+    return _finishLoad();
 }
 
 /**
- * helper method, updates user's rank vector according to the input file
- * @param i number of the watched movies so far + 1
- * @param clientName
- * @param val current movie rank parsed from the file
+ * writes the loaded movies and clients as a binary snapshot, for loadSnapshot
+ * @param snapshotFilePath
+ * @return 0 upon success, -1 upon failure
  */
-void RecommenderSystem::_updateUserRank(int &i, const std::string &clientName,
-                                        const std::string &val)
+int RecommenderSystem::saveSnapshot(const std::string &snapshotFilePath)
 {
-    if (val == NA)
+    SnapshotWriter writer;
+    if (writer.open(snapshotFilePath, _movieNames, _attributeRows()) != LOAD_SUCCESS)
     {
-        _clients[clientName].push_back(0.0);
+        printMessage(OPEN_FAIL, snapshotFilePath);
+        return LOAD_FAIL;
     }
-    else
+    for (size_t c = 0; c < _clientNames.size(); c++)
+    {
+        if (writer.addClient(_clientNames[c], *_clientRanks[c]) != LOAD_SUCCESS)
+        {
+            return LOAD_FAIL;
+        }
+    }
+    return writer.close();
+}
+
+/**
+ * helper method, derives the state shared by every query from the loaded movies
+ * @return 0 upon success, -1 if a movie of the ranks has no attributes or the movies have
+ * different numbers of attributes
+ */
+int RecommenderSystem::_finishLoad()
+{
+    RECOMMENDER_TRACE_SPAN("_finishLoad", "load");
+    // the kernels and the queries read the attributes of any movie unchecked, so every movie of
+    // the ranks needs a line in the movies file and every line the same number of attributes
+    size_t dims = _movies.empty() ? 0 : _movies.begin()->second.size();
+    for (const auto &movie : _movies)
+    {
+        if (movie.second.size() != dims)
+        {
+            return LOAD_FAIL;
+        }
+    }
+    for (const std::string &movie : _movieNames)
+    {
+        if (!_movies.count(movie))
+        {
+            return LOAD_FAIL;
+        }
+    }
+    // the attribute count is fixed from now on, so the kernels can be specialized for it
+    _kernels = VectorMath::exactKernelsFor(dims);
+    _attributeMeans.assign(dims, 0.0);
+    for (const std::string &movie : _movieNames)
+    {
+        VectorMath::axpy(1.0 / _movieNames.size(), _movies.find(movie)->second.data(),
+                         _attributeMeans.data(), dims);
+    }
+    // the queries read clients and movies by index, their names are looked up once per call
+    _clientRanks = _rankRows();
+    _clientRankCounts.clear();
+    for (const std::string &client : _clientNames)
+    {
+        auto ranked = _clientsRanksNum.find(client);
+        _clientRankCounts.push_back((ranked == _clientsRanksNum.end()) ? 0 : ranked->second);
+    }
+    _movieAttributes = _attributeRows();
+    _moviesByName.clear();
+    for (const auto &movie : _movieIds)
     {
-        _clients[clientName].push_back(std::stod(val));
-        _clientsRanksNum[clientName] = i; // saves the number of movies watched
-        // by each client
-        i++;
+        _moviesByName.push_back(movie.second);
     }
+    return LOAD_SUCCESS;
 }
 
 /**
@@ -129,34 +402,74 @@ void RecommenderSystem::_updateUserRank(int &i, const std::string &clientName,
  */
 std::string RecommenderSystem::recommendByContent(const std::string &userName)
 {
-    if (_clients.count(userName))
-    {// normalization:
-        std::vector<double> curNorm = _getNormRankVec(userName);
-        // create pref vector:
-        std::vector<double> prefVec = _createPrefVec(userName, curNorm);
-        return _findMovieByPref(userName, prefVec).name;
-    }
-    else
+    return recommendByContent<CosineSimilarity>(userName);
+}
+
+/**
+ * recommendByContent with another similarity metric in place of the cosine similarity,
+ * e.g. rs.recommendByContent<PearsonSimilarity>(userName). the metric is picked at compile
+ * time, see Similarity.h for the available ones.
+ * @tparam Similarity the similarity metric
+ * @param userName client name
+ * @return movie recommended upon success, invalid client name message upon failure
+ */
+template<class Similarity>
+std::string RecommenderSystem::recommendByContent(const std::string &userName)
+{
+    return recommendByContent<Similarity>(lookupUser(userName));
+}
+
+/**
+ * recommendByContent for a client resolved by lookupUser, skipping the name lookups
+ * @param user
+ * @return movie recommended upon success, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendByContent(UserHandle user)
+{
+    return recommendByContent<CosineSimilarity>(user);
+}
+
+/**
+ * the handle overload of recommendByContent with another similarity metric
+ * @tparam Similarity the similarity metric
+ * @param user
+ * @return movie recommended upon success, invalid client name message upon failure
+ */
+template<class Similarity>
+std::string RecommenderSystem::recommendByContent(UserHandle user)
+{
+    RECOMMENDER_TIME_METHOD(RECOMMEND_BY_CONTENT);
+    if (!_isClient(user.id))
     {
         return INVALID_USER;
     }
+    RECOMMENDER_TRACE_SPAN("recommendByContent", "query", _clientNames[user.id].c_str());
+    ArenaScope scope;
+    // normalization:
+    ArenaVector<double> curNorm = _getNormRankVec(user.id);
+    // create pref vector:
+    ArenaVector<double> prefVec = _createPrefVec(user.id, curNorm);
+    return _movieName(_findMovieByPref<Similarity>(user.id, prefVec).movie);
 }
 
 /**
  * helper method to calculate the normalized ranks vector of a given client
- * @param user client name
- * @return the normalized preference vector of the client
+ * @param user client index
+ * @return the normalized preference vector of the client, in the arena of the query
  */
-std::vector<double> RecommenderSystem::_getNormRankVec(const std::string &user)
+ArenaVector<double> RecommenderSystem::_getNormRankVec(size_t user)
 {
-    double n = _clientsRanksNum[user];
+    RECOMMENDER_TIME_PHASE(NORM_RANK_VEC);
+    RECOMMENDER_TRACE_SPAN("_getNormRankVec", "phase");
+    const std::vector<double> &userRanks = *_clientRanks[user];
+    double n = _clientRankCounts[user];
     double avg = 0.0;
     if (n != 0.0)
     {
-        avg = std::accumulate(_clients[user].begin(), _clients[user].end(), 0.0);
+        avg = std::accumulate(userRanks.begin(), userRanks.end(), 0.0);
         avg = avg / n;
     }
-    std::vector<double> curNorm(_clients[user]);
+    ArenaVector<double> curNorm(userRanks.begin(), userRanks.end());
     for (double &elem : curNorm)
     {
         elem = (elem == 0.0) ? elem : elem - avg;
@@ -166,28 +479,23 @@ std::vector<double> RecommenderSystem::_getNormRankVec(const std::string &user)
 
 /**
  * creates the preference vector of a given client based on past ranks and movie attributes
- * @param user client name
+ * @param user client index
  * @param curNorm normalized preference vector of the client
- * @return the clients preference vector
+ * @return the clients preference vector, in the arena of the query
  */
-std::vector<double>
-RecommenderSystem::_createPrefVec(const std::string &user, const std::vector<double> &curNorm)
+ArenaVector<double>
+RecommenderSystem::_createPrefVec(size_t user, const ArenaVector<double> &curNorm)
 {
-    std::vector<double> prefVec(_movies[_movieNames[0]].size());
-    for (std::vector<double>::size_type i = 0; i < _clients[user].size(); i++)
+    RECOMMENDER_TIME_PHASE(CREATE_PREF_VEC);
+    RECOMMENDER_TRACE_SPAN("_createPrefVec", "phase");
+    ArenaVector<double> prefVec(_movieAttributes[0]->size());
+    for (std::vector<double>::size_type i = 0; i < _clientRanks[user]->size(); i++)
     {
         if (curNorm[i] != 0.0)
         {
-            double scalar = curNorm[i];
-            std::vector<double> curMovie(_movies[_movieNames[i]]);
-            for (double &elem : curMovie)
-            {
-                elem *= scalar;
-            }
-            for (std::vector<double>::size_type j = 0; j < prefVec.size(); j++)
-            {
-                prefVec[j] += curMovie[j];
-            }
+            // scaled in place of a scaled copy of the movie, which rounds the same
+            VectorMath::axpy(curNorm[i], _movieAttributes[i]->data(), prefVec.data(),
+                             prefVec.size());
         }
     }
     return prefVec;
@@ -195,85 +503,124 @@ RecommenderSystem::_createPrefVec(const std::string &user, const std::vector<dou
 
 /**
  * finds the best movie to recommend based on the users' preference vector of movie attributes
- * @param user clients' name
+ * @tparam Similarity the similarity metric, see Similarity.h
+ * @param user clients' index
  * @param prefVec clients' preference vector
- * @return a resMovie struct, contains the recommended movie's name and resemblance score
+ * @return a resMovie struct, contains the recommended movie's index and resemblance score,
+ * the index is the number of movies if the client watched them all
  */
-resMovie RecommenderSystem::_findMovieByPref(const std::string &user,
-                                             const std::vector<double> &prefVec)
+template<class Similarity>
+resMovie RecommenderSystem::_findMovieByPref(size_t user, const ArenaVector<double> &prefVec)
 {
-    std::string closest;
-    double closestScore = -2.0;
+    RECOMMENDER_TIME_PHASE(FIND_MOVIE_BY_PREF);
+    RECOMMENDER_TRACE_SPAN("_findMovieByPref", "phase");
+    size_t closest = _movieNames.size(); // none
+    double closestScore = -HUGE_VAL;
     double prefNorm = _norm(prefVec);
+    if (std::is_same<Similarity, CosineSimilarity>::value && _contentClusters.isBuilt() &&
+        prefNorm != 0.0)
+    { // same scores as the scan below, but only for the clusters that may hold the best movie
+        const std::vector<double> &userRanks = *_clientRanks[user];
+        closestScore = _contentClusters.search(prefVec.data(), [&userRanks](size_t i)
+        {
+            return userRanks[i] == 0.0;
+        }, [this, &prefVec, prefNorm](size_t i)
+        {
+            RECOMMENDER_COUNT(MOVIES_SCORED, 1);
+            const std::vector<double> &movie = *_movieAttributes[i];
+            return _dotProd(movie, prefVec) / (_norm(movie) * prefNorm);
+        }, closest); // left as none if no movie is allowed
+        resMovie out = {.score = closestScore, .movie = closest};
+        return out;
+    }
+    SimilarityContext ctx = _similarityContext();
+    VectorStats prefStats = Similarity::stats(prefVec.data(), ctx);
+    RECOMMENDER_COUNT(MOVIES_SCORED, _movieNames.size() - _clientRankCounts[user]);
+    const std::vector<double> &userRanks = *_clientRanks[user];
     for (std::vector<double>::size_type i = 0; i < _movieNames.size(); i++)
     {
-        if (_clients[user][i] == 0.0)
+        if (userRanks[i] == 0.0)
         {
-            double normsProd = _norm(_movies[_movieNames[i]]) * prefNorm;
-            double curScore = _dotProd(_movies[_movieNames[i]], prefVec) / normsProd;
+            const double *movie = _movieAttributes[i]->data();
+            double curScore = Similarity::similarity(movie, Similarity::stats(movie, ctx),
+                                                     prefVec.data(), prefStats, ctx);
             if (curScore > closestScore)
             {
                 closestScore = curScore;
-                closest = _movieNames[i];
+                closest = i;
             }
         }
     }
-    resMovie out = {.score = closestScore, .name = closest};
+    resMovie out = {.score = closestScore, .movie = closest};
     return out;
 }
 
 /**
- * helper method which calculate the dot product of two vectors
+ * helper method which calculate the dot product of two vectors, with the kernel
+ * specialized for the attribute count when the length matches it
+ * @tparam AllocA the allocator of a
+ * @tparam AllocB the allocator of b
  * @param a first vector
  * @param b second vector
  * @return the dot product
  */
-double RecommenderSystem::_dotProd(const std::vector<double> &a, const std::vector<double> &b)
+template<class AllocA, class AllocB>
+double RecommenderSystem::_dotProd(const std::vector<double, AllocA> &a,
+                                  const std::vector<double, AllocB> &b) const
 {
-    double out = 0.0;
-    for (std::vector<double>::size_type j = 0; j < a.size(); j++)
+    if (a.size() == _kernels.dims)
     {
-        out += a[j] * b[j];
+        return _kernels.dotProd(a.data(), b.data(), a.size());
     }
-    return out;
+    return VectorMath::exactDotProd(a.data(), b.data(), a.size());
 }
 
 /**
- * helper method which calculate the norm of a given vector
+ * helper method which calculate the norm of a given vector, with the kernel
+ * specialized for the attribute count when the length matches it
+ * @tparam Alloc the allocator of the vector, for the query temporaries of the arena
  * @param vec
  * @return the norm of vec
  */
-double RecommenderSystem::_norm(const std::vector<double> &vec)
+template<class Alloc>
+double RecommenderSystem::_norm(const std::vector<double, Alloc> &vec) const
 {
-    double sum = 0.0;
-    for (double elem : vec)
+    if (vec.size() == _kernels.dims)
     {
-        sum += pow(elem, 2.0);
+        return _kernels.norm(vec.data(), vec.size());
     }
-    return sqrt(sum);
+    return VectorMath::exactNorm(vec.data(), vec.size());
 }
 
 /**
  * creates a vector of past ranked movies, sorted by resemblance to certain movie attributes, from
  * the closest to the most different one
+ * @tparam Similarity the similarity metric, see Similarity.h
  * @param movieAttributes the movie attributes according to which we sort
- * @param userHistory a map of the clients' past movies and their rankings
- * @return the sorted vector of past ranked movies in the above mentioned order
+ * @param userHistory the indices of the clients' past movies, by the order of their names
+ * @return the past ranked movies ranked in the above mentioned order, in the arena of the query
  */
-std::vector<resMovie>
-RecommenderSystem::_findMovieByHistory(const std::vector<double> &movieAttributes,
-                                       const std::map<std::string, double> &userHistory)
+template<class Similarity>
+ScoredMovies RecommenderSystem::_findMovieByHistory(const std::vector<double> &movieAttributes,
+                                                    const ArenaVector<size_t> &userHistory)
 {
-    std::vector<resMovie> res;
-    double movieNorm = _norm(movieAttributes);
-    for (const auto& pair : userHistory)
+    RECOMMENDER_TIME_PHASE(FIND_MOVIE_BY_HISTORY);
+    RECOMMENDER_TRACE_SPAN("_findMovieByHistory", "phase");
+    RECOMMENDER_COUNT(HISTORY_SORTED, userHistory.size());
+    ScoredMovies res;
+    res.scores.reserve(userHistory.size());
+    res.movies.reserve(userHistory.size());
+    SimilarityContext ctx = _similarityContext();
+    VectorStats movieStats = Similarity::stats(movieAttributes.data(), ctx);
+    for (size_t movie : userHistory)
     {
-        double curNorm = _norm(_movies[pair.first]) * movieNorm;
-        double curScore = _dotProd(movieAttributes, _movies[pair.first]) / curNorm;
-        resMovie curMovie = {.score = curScore, .name = pair.first};
-        res.push_back(curMovie);
+        const double *cur = _movieAttributes[movie]->data();
+        double curScore = Similarity::similarity(movieAttributes.data(), movieStats, cur,
+                                                 Similarity::stats(cur, ctx), ctx);
+        res.scores.push_back(curScore);
+        res.movies.push_back((uint32_t) movie);
     }
-    std::sort (res.begin(), res.end(), _compResMovie);
+    _rankByScore(res);
     return res;
 }
 
@@ -290,31 +637,111 @@ RecommenderSystem::_findMovieByHistory(const std::vector<double> &movieAttribute
 double RecommenderSystem::predictMovieScoreForUser(const std::string &movieName,
                                                    const std::string&userName, int k)
 {
-    if (_clients.count(userName) && _movies.count(movieName))
+    return predictMovieScoreForUser<CosineSimilarity>(movieName, userName, k);
+}
+
+/**
+ * predictMovieScoreForUser with another similarity metric in place of the cosine
+ * similarity. the metric is picked at compile time, see Similarity.h for the available ones.
+ * @tparam Similarity the similarity metric
+ * @param movieName the movie for which we predict the clients' rank
+ * @param userName client name
+ * @param k
+ * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+ * the database, returns -1
+ */
+template<class Similarity>
+double RecommenderSystem::predictMovieScoreForUser(const std::string &movieName,
+                                                   const std::string &userName, int k)
+{
+    RECOMMENDER_TIME_METHOD(PREDICT_MOVIE_SCORE);
+    UserHandle user = lookupUser(userName);
+    auto attributes = _movies.find(movieName);
+    if (user.id == INVALID_HANDLE || attributes == _movies.end())
     {
-        double numerator = 0.0;
-        double denominator = 0.0;
-        std::map<std::string, double> clientHistory;
-        for (std::vector<std::string>::size_type i = 0; i < _movieNames.size(); i++)
-        { // create map to users ratings
-            if (_clients[userName][i] != 0.0)
-            {
-                clientHistory[_movieNames[i]] = _clients[userName][i];
-            }
-        }
-        std::vector<resMovie> sorted = _findMovieByHistory(_movies[movieName], clientHistory);
-        for (int i = 0; i < k; i++) // get the k most resemble movies
+        return NOT_EXSISTS;
+    }
+    auto movie = _movieIds.find(movieName);
+    return _predictForUser<Similarity>(attributes->second, (movie == _movieIds.end()) ?
+                                                           _movieNames.size() : movie->second,
+                                       user.id, k);
+}
+
+/**
+ * predictMovieScoreForUser for a movie and client resolved by lookupMovie and lookupUser,
+ * skipping the name lookups
+ * @param movie
+ * @param user
+ * @param k
+ * @return the prediction of the clients' rank to the movie, -1 for an invalid handle
+ */
+double RecommenderSystem::predictMovieScoreForUser(MovieHandle movie, UserHandle user, int k)
+{
+    return predictMovieScoreForUser<CosineSimilarity>(movie, user, k);
+}
+
+/**
+ * the handle overload of predictMovieScoreForUser with another similarity metric
+ * @tparam Similarity the similarity metric
+ * @param movie
+ * @param user
+ * @param k
+ * @return the prediction of the clients' rank to the movie, -1 for an invalid handle
+ */
+template<class Similarity>
+double RecommenderSystem::predictMovieScoreForUser(MovieHandle movie, UserHandle user, int k)
+{
+    RECOMMENDER_TIME_METHOD(PREDICT_MOVIE_SCORE);
+    if (!_isClient(user.id) || movie.id >= _movieNames.size())
+    {
+        return NOT_EXSISTS;
+    }
+    return _predictForUser<Similarity>(*_movieAttributes[movie.id], movie.id, user.id, k);
+}
+
+/**
+ * the prediction of predictMovieScoreForUser, for a client and movie already resolved
+ * @tparam Similarity the similarity metric, see Similarity.h
+ * @param movieAttributes the attributes of the movie we predict for
+ * @param movie its index, or the number of movies if it is not in the ranks file
+ * @param user client index
+ * @param k
+ * @return the prediction of the clients' rank to the movie
+ */
+template<class Similarity>
+double RecommenderSystem::_predictForUser(const std::vector<double> &movieAttributes,
+                                          size_t movie, size_t user, int k)
+{
+    RECOMMENDER_TRACE_SPAN("predictMovieScoreForUser", "query",
+                           (movie < _movieNames.size()) ? _movieNames[movie].c_str() : nullptr);
+    ArenaScope scope;
+    const std::vector<double> &userRanks = *_clientRanks[user];
+    double prediction;
+    if (std::is_same<Similarity, CosineSimilarity>::value && movie < _movieNames.size() &&
+        _predictByLists(movie, userRanks, k, prediction))
+    {
+        RECOMMENDER_COUNT(LIST_PREDICTIONS, 1);
+        return prediction;
+    }
+    double numerator = 0.0;
+    double denominator = 0.0;
+    ArenaVector<size_t> clientHistory;
+    clientHistory.reserve(_clientRankCounts[user]);
+    for (size_t ranked : _moviesByName)
+    { // the users ratings, by movie name
+        if (userRanks[ranked] != 0.0)
         {
-            resMovie closest = sorted[i];
-            numerator += closest.score * clientHistory[closest.name];
-            denominator += closest.score;
+            clientHistory.push_back(ranked);
         }
-        return numerator / denominator;
     }
-    else
+    ScoredMovies sorted = _findMovieByHistory<Similarity>(movieAttributes, clientHistory);
+    for (int i = 0; i < k; i++) // get the k most resemble movies
     {
-        return NOT_EXSISTS;
+        resMovie closest = sorted[i];
+        numerator += closest.score * userRanks[closest.movie];
+        denominator += closest.score;
     }
+    return numerator / denominator;
 }
 
 /**
@@ -327,39 +754,1051 @@ double RecommenderSystem::predictMovieScoreForUser(const std::string &movieName,
  */
 std::string RecommenderSystem::recommendByCF(const std::string &userName, int k)
 {
-    if (_clients.count(userName))
+    return recommendByCF<CosineSimilarity>(userName, k);
+}
+
+/**
+ * recommendByCF with another similarity metric in place of the cosine similarity. the
+ * metric is picked at compile time, see Similarity.h for the available ones.
+ * @tparam Similarity the similarity metric
+ * @param userName clients name
+ * @param k
+ * @return the name of the movie for which our prediction is the highest
+ */
+template<class Similarity>
+std::string RecommenderSystem::recommendByCF(const std::string &userName, int k)
+{
+    return recommendByCF<Similarity>(lookupUser(userName), k);
+}
+
+/**
+ * recommendByCF for a client resolved by lookupUser, skipping the name lookups
+ * @param user
+ * @param k
+ * @return the name of the movie for which our prediction is the highest
+ */
+std::string RecommenderSystem::recommendByCF(UserHandle user, int k)
+{
+    return recommendByCF<CosineSimilarity>(user, k);
+}
+
+/**
+ * the handle overload of recommendByCF with another similarity metric
+ * @tparam Similarity the similarity metric
+ * @param user
+ * @param k
+ * @return the name of the movie for which our prediction is the highest
+ */
+template<class Similarity>
+std::string RecommenderSystem::recommendByCF(UserHandle user, int k)
+{
+    RECOMMENDER_TIME_METHOD(RECOMMEND_BY_CF);
+    if (!_isClient(user.id))
     {
-        std::string bestPrediction;
-        double bestScore = -2.0;
-        for (size_t i = 0; i < _movieNames.size(); i++) // create map to users ratings
+        return INVALID_USER;
+    }
+    RECOMMENDER_TRACE_SPAN("recommendByCF", "query", _clientNames[user.id].c_str());
+    ArenaScope scope;
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    size_t bestPrediction = _movieNames.size(); // none
+    double bestScore = -HUGE_VAL;
+    for (size_t i = 0; i < _movieNames.size(); i++)
+    {
+        if (userRanks[i] == 0.0)
         {
-            if (_clients[userName][i] == 0.0)
+            double curScore = _predictForUser<Similarity>(*_movieAttributes[i], i, user.id, k);
+            if (bestScore < curScore)
             {
-                double curScore = predictMovieScoreForUser(_movieNames[i], userName, k);
-                if (bestScore < curScore)
-                {
-                    bestScore = curScore;
-                    bestPrediction = _movieNames[i];
-                }
+                bestScore = curScore;
+                bestPrediction = i;
             }
         }
-        return bestPrediction;
     }
-    else
+    return _movieName(bestPrediction);
+}
+
+/**
+ * resolves a client name once, for the handle overloads of the queries
+ * @param userName client name
+ * @return the client's handle, with the id INVALID_HANDLE if there is no such client or its
+ * line holds no ranks
+ */
+UserHandle RecommenderSystem::lookupUser(const std::string &userName) const
+{
+    auto user = _clientIds.find(userName);
+    UserHandle out = {(user == _clientIds.end() || !_isClient(user->second)) ? INVALID_HANDLE :
+                      user->second};
+    return out;
+}
+
+/**
+ * resolves a movie name once, for the handle overloads of the queries
+ * @param movieName movie name
+ * @return the movie's handle, with the id INVALID_HANDLE if the movie is not in the ranks
+ * file or has no attributes
+ */
+MovieHandle RecommenderSystem::lookupMovie(const std::string &movieName) const
+{
+    auto movie = _movieIds.find(movieName);
+    MovieHandle out = {(movie == _movieIds.end() || !_movies.count(movieName)) ? INVALID_HANDLE :
+                       movie->second};
+    return out;
+}
+
+/**
+ * blends the content based and the cf algorithms into one ranking, scoring every unwatched
+ * movie by weight * c + (1 - weight) * p / maxRank, where c is the cosine of the movie and
+ * the client's preference vector (as in recommendByContent), p is the prediction of
+ * predictMovieScoreForUser and maxRank is the client's highest rank. both scores come out of
+ * a single pass over the unwatched movies, which shares the preference vector, the ranked
+ * movies and the attribute norms between them.
+ * @param userName client name
+ * @param k the k of the cf prediction
+ * @param weight weight of the content score, between 0 (cf only) and 1 (content only)
+ * @return the movie with the highest blended score, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendHybrid(const std::string &userName, int k, double weight)
+{
+    RECOMMENDER_TIME_METHOD(RECOMMEND_HYBRID);
+    RECOMMENDER_TRACE_SPAN("recommendHybrid", "query", userName.c_str());
+    ArenaScope scope;
+    UserHandle user = lookupUser(userName);
+    if (user.id == INVALID_HANDLE)
     {
         return INVALID_USER;
     }
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    ArenaVector<double> prefVec = _createPrefVec(user.id, _getNormRankVec(user.id));
+    double prefNorm = _norm(prefVec);
+    const std::vector<const std::vector<double> *> &movies = _movieAttributes;
+    RankedHistory history = _rankedHistory(userRanks, movies);
+    double maxRank = 0.0;
+    for (size_t movie : history.movies)
+    {
+        maxRank = std::max(maxRank, userRanks[movie]);
+    }
+    size_t best = _movieNames.size(); // none
+    double bestScore = -HUGE_VAL;
+    for (size_t i = 0; i < _movieNames.size(); i++)
+    {
+        if (userRanks[i] != 0.0)
+        {
+            continue;
+        }
+        double movieNorm = _norm(*movies[i]);
+        double content = _dotProd(*movies[i], prefVec) / (movieNorm * prefNorm);
+        double prediction = _predictByRanked(i, movieNorm, userRanks, movies, k, history);
+        double curScore = weight * content + (1.0 - weight) * prediction / maxRank;
+        if (curScore > bestScore)
+        {
+            bestScore = curScore;
+            best = i;
+        }
+    }
+    return _movieName(best);
 }
 
 /**
- * comperator function for the resMovie struct, based on the movies' score.
- * @param lhs
- * @param rhs
- * @return the bool value of the statement lhs.score > rhs.score
+ * lists the movies a client ranked with their attribute norms
+ * @param userRanks the client's rank vector
+ * @param movies the attribute vector of every movie, in the order of _movieNames
+ * @return the ranked movies, ready for _predictByRanked
  */
-bool RecommenderSystem::_compResMovie(const resMovie &lhs, const resMovie &rhs)
+RecommenderSystem::RankedHistory
+RecommenderSystem::_rankedHistory(const std::vector<double> &userRanks,
+                                  const std::vector<const std::vector<double> *> &movies) const
 {
-    return lhs.score > rhs.score;
+    RankedHistory history;
+    for (size_t i = 0; i < userRanks.size(); i++)
+    {
+        if (userRanks[i] != 0.0)
+        {
+            history.movies.push_back(i);
+            history.norms.push_back(_norm(*movies[i]));
+        }
+    }
+    history.scored.resize(history.movies.size());
+    return history;
+}
+
+/**
+ * the prediction of predictMovieScoreForUser by the precomputed lists of similar movies: the
+ * neighbor lists of buildMovieNeighbors, or else the graph of buildSimilarityGraph
+ * @param movie the predicted movie
+ * @param userRanks the client's rank vector
+ * @param k
+ * @param prediction output, the prediction if found
+ * @return true if a built list of the movie holds k movies the client ranked
+ */
+bool RecommenderSystem::_predictByLists(size_t movie, const std::vector<double> &userRanks, int k,
+                                        double &prediction) const
+{
+    if (_movieNeighbors.isBuilt() && _movieNeighbors.predict(movie, userRanks, k, prediction))
+    {
+        return true;
+    }
+    return _similarityGraph.isBuilt() && _similarityGraph.predict(movie, userRanks, k, prediction);
+}
+
+/**
+ * the prediction of predictMovieScoreForUser, by the precomputed lists when they are built, and
+ * otherwise by picking the k closest ranked movies with a partial sort instead of sorting the
+ * whole history
+ * @param movie the predicted movie
+ * @param movieNorm the norm of its attributes
+ * @param userRanks the client's rank vector
+ * @param movies the attribute vector of every movie, in the order of _movieNames
+ * @param k
+ * @param history the client's ranked movies, from _rankedHistory
+ * @return the prediction
+ */
+double RecommenderSystem::_predictByRanked(size_t movie, double movieNorm,
+                                           const std::vector<double> &userRanks,
+                                           const std::vector<const std::vector<double> *> &movies,
+                                           int k, RankedHistory &history) const
+{
+    double prediction;
+    if (_predictByLists(movie, userRanks, k, prediction))
+    {
+        return prediction;
+    }
+    ArenaVector<std::pair<double, size_t> > &scored = history.scored;
+    for (size_t p = 0; p < history.movies.size(); p++)
+    {
+        scored[p].first = _dotProd(*movies[movie], *movies[history.movies[p]]) /
+                          (history.norms[p] * movieNorm);
+        scored[p].second = history.movies[p];
+    }
+    size_t keep = std::min(scored.size(), (size_t) std::max(k, 0));
+    std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                      [](const std::pair<double, size_t> &lhs, const std::pair<double, size_t> &rhs)
+    {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    });
+    double numerator = 0.0;
+    double denominator = 0.0;
+    for (size_t p = 0; p < keep; p++)
+    {
+        numerator += scored[p].first * userRanks[scored[p].second];
+        denominator += scored[p].first;
+    }
+    return numerator / denominator;
+}
+
+/**
+ * the unwatched movies of a client that pass the filters, as a bitmap. the filters are applied
+ * by the bitmap index when buildAttributeIndex was called, and by the attribute vectors
+ * otherwise.
+ * @param userRanks the client's rank vector
+ * @param filters
+ * @return bit i of word i / 64 is set if movie i is a candidate, in the arena of the query
+ */
+ArenaVector<uint64_t> RecommenderSystem::_filteredUnwatched(const std::vector<double> &userRanks,
+                                                            const std::vector<AttributeFilter>
+                                                            &filters)
+{
+    ArenaVector<uint64_t> allowed((_movieNames.size() + WORD_BITS - 1) / WORD_BITS, 0);
+    for (size_t i = 0; i < _movieNames.size(); i++)
+    {
+        if (userRanks[i] == 0.0)
+        {
+            allowed[i / WORD_BITS] |= (uint64_t) 1 << (i % WORD_BITS);
+        }
+    }
+    if (_attributeIndex.isBuilt() &&
+        _attributeIndex.select(filters, allowed.data(), allowed.size()))
+    {
+        return allowed;
+    }
+    for (size_t w = 0; w < allowed.size(); w++)
+    { // check the remaining candidates one by one
+        for (uint64_t bits = allowed[w]; bits != 0; bits &= bits - 1)
+        {
+            size_t i = w * WORD_BITS + __builtin_ctzll(bits);
+            const std::vector<double> &movie = *_movieAttributes[i];
+            for (const AttributeFilter &filter : filters)
+            {
+                if (!filter.matches(movie))
+                {
+                    allowed[w] &= ~((uint64_t) 1 << (i % WORD_BITS));
+                    break;
+                }
+            }
+        }
+    }
+    return allowed;
+}
+
+/**
+ * orders scored movies from the highest score to the lowest, ties going to the lower index,
+ * and keeps the names of the first n
+ * @param scored pairs of score and movie index
+ * @param n
+ * @return the names of the n best movies
+ */
+std::vector<std::string> RecommenderSystem::_topNames(ArenaVector<std::pair<double, size_t> >
+                                                      &scored, int n) const
+{
+    size_t keep = std::min(scored.size(), (size_t) std::max(n, 0));
+    std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                      [](const std::pair<double, size_t> &lhs, const std::pair<double, size_t> &rhs)
+    {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    });
+    std::vector<std::string> out;
+    out.reserve(keep);
+    for (size_t p = 0; p < keep; p++)
+    {
+        out.push_back(_movieNames[scored[p].second]);
+    }
+    return out;
+}
+
+/**
+ * builds the bitmap indexes of the movie attributes, which the filtered recommendByContent and
+ * recommendByCF then intersect with the unwatched movies before scoring any movie
+ * @return 0 upon success, -1 when no data was loaded
+ */
+int RecommenderSystem::buildAttributeIndex()
+{
+    return _attributeIndex.build(_attributeRows());
+}
+
+/**
+ * the n best movies of the content based algorithm, between the unwatched movies that pass all
+ * the filters. only those movies are scored.
+ * @param userName client name
+ * @param filters conditions on the movie attributes, e.g. {2, 7.0, HUGE_VAL} for attribute 2
+ * at least 7
+ * @param n number of movies to recommend
+ * @return the recommended movies from the best to the worst, empty if the client is not in the
+ * database
+ */
+std::vector<std::string> RecommenderSystem::recommendByContent(const std::string &userName,
+                                                               const std::vector<AttributeFilter>
+                                                               &filters, int n)
+{
+    UserHandle user = lookupUser(userName);
+    if (user.id == INVALID_HANDLE || n <= 0)
+    {
+        return std::vector<std::string>();
+    }
+    ArenaScope scope;
+    ArenaVector<std::pair<double, size_t> > scored;
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    ArenaVector<uint64_t> allowed = _filteredUnwatched(userRanks, filters);
+    ArenaVector<double> prefVec = _createPrefVec(user.id, _getNormRankVec(user.id));
+    double prefNorm = _norm(prefVec);
+    for (size_t w = 0; w < allowed.size(); w++)
+    {
+        for (uint64_t bits = allowed[w]; bits != 0; bits &= bits - 1)
+        {
+            size_t i = w * WORD_BITS + __builtin_ctzll(bits);
+            const std::vector<double> &movie = *_movieAttributes[i];
+            scored.emplace_back(_dotProd(movie, prefVec) / (_norm(movie) * prefNorm), i);
+        }
+    }
+    return _topNames(scored, n);
+}
+
+/**
+ * the n movies with the highest cf predictions, between the unwatched movies that pass all
+ * the filters. only those movies are predicted.
+ * @param userName client name
+ * @param k the k of the prediction
+ * @param filters conditions on the movie attributes
+ * @param n number of movies to recommend
+ * @return the recommended movies from the best to the worst, empty if the client is not in the
+ * database
+ */
+std::vector<std::string> RecommenderSystem::recommendByCF(const std::string &userName, int k,
+                                                          const std::vector<AttributeFilter>
+                                                          &filters, int n)
+{
+    UserHandle user = lookupUser(userName);
+    if (user.id == INVALID_HANDLE || n <= 0)
+    {
+        return std::vector<std::string>();
+    }
+    ArenaScope scope;
+    ArenaVector<std::pair<double, size_t> > scored;
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    ArenaVector<uint64_t> allowed = _filteredUnwatched(userRanks, filters);
+    const std::vector<const std::vector<double> *> &movies = _movieAttributes;
+    RankedHistory history = _rankedHistory(userRanks, movies);
+    for (size_t w = 0; w < allowed.size(); w++)
+    {
+        for (uint64_t bits = allowed[w]; bits != 0; bits &= bits - 1)
+        {
+            size_t i = w * WORD_BITS + __builtin_ctzll(bits);
+            scored.emplace_back(_predictByRanked(i, _norm(*movies[i]), userRanks, movies, k,
+                                                 history), i);
+        }
+    }
+    return _topNames(scored, n);
+}
+
+/**
+ * builds the movie major copy of the ranks used by topUsersForMovie, and starts the workers that
+ * predict from it, so the queries only read them
+ * @return 0 upon success, -1 when no data was loaded
+ */
+int RecommenderSystem::buildMovieRaters()
+{
+    _threadPool();
+    return _movieRaters.build(_clientRanks, _movieNames.size());
+}
+
+/**
+ * @return true once the workers were started, by loadData for a ranks file of a few chunks
+ * or by a builder. the work they do is not seen by the counters of the calling thread
+ */
+bool RecommenderSystem::workersStarted() const
+{
+    return _pool != nullptr;
+}
+
+/**
+ * the n clients with the highest predictions of predictMovieScoreForUser for a movie, between
+ * the clients who did not rank it. all the clients are predicted in one parallel pass over the
+ * movie major copy of buildMovieRaters, instead of a history map and a sort per client.
+ * @param movieName the movie to find an audience for
+ * @param k the k of the prediction
+ * @param n number of clients to return
+ * @return the clients from the highest prediction to the lowest, empty if the movie is not in the
+ * database or buildMovieRaters was not called
+ */
+std::vector<std::string> RecommenderSystem::topUsersForMovie(const std::string &movieName, int k,
+                                                             int n)
+{
+    RECOMMENDER_TIME_METHOD(TOP_USERS_FOR_MOVIE);
+    RECOMMENDER_TRACE_SPAN("topUsersForMovie", "query", movieName.c_str());
+    std::vector<std::string> out;
+    auto target = _movieIds.find(movieName);
+    if (target == _movieIds.end() || !_movieRaters.isBuilt() || k <= 0 || n <= 0)
+    {
+        return out;
+    }
+    // the similarity of every movie to the target, as _findMovieByHistory computes it
+    const std::vector<const std::vector<double> *> &movies = _movieAttributes;
+    const std::vector<double> &targetAttributes = *movies[target->second];
+    double targetNorm = _norm(targetAttributes);
+    std::vector<double> sims(movies.size());
+    std::vector<unsigned int> order(movies.size());
+    for (size_t j = 0; j < movies.size(); j++)
+    {
+        sims[j] = _dotProd(targetAttributes, *movies[j]) / (targetNorm * _norm(*movies[j]));
+        order[j] = (unsigned int) j;
+    }
+    std::sort(order.begin(), order.end(), [&sims](unsigned int lhs, unsigned int rhs)
+    {
+        return sims[lhs] > sims[rhs] || (sims[lhs] == sims[rhs] && lhs < rhs);
+    });
+    std::vector<double> predictions;
+    _movieRaters.predictAll(target->second, order, sims, k, _threadPool(), predictions);
+    std::vector<std::pair<double, size_t> > scored;
+    for (size_t u = 0; u < _clientNames.size(); u++)
+    {
+        if (_isClient(u) && (*_clientRanks[u])[target->second] == 0.0 &&
+            !std::isnan(predictions[u]))
+        {
+            scored.emplace_back(predictions[u], u);
+        }
+    }
+    size_t keep = std::min(scored.size(), (size_t) n);
+    std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                      [](const std::pair<double, size_t> &lhs, const std::pair<double, size_t> &rhs)
+    {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    });
+    for (size_t p = 0; p < keep; p++)
+    {
+        out.push_back(_clientNames[scored[p].second]);
+    }
+    return out;
+}
+
+/**
+ * @return what the similarity metrics need to know about the loaded data
+ */
+SimilarityContext RecommenderSystem::_similarityContext() const
+{
+    SimilarityContext ctx = {_kernels.dims, _kernels, _attributeMeans.data()};
+    return ctx;
+}
+
+/**
+ * ranks the candidates by their score alone, from the highest. sorts their positions with
+ * the comparisons a sort of whole records would make, so tied candidates end up in the
+ * same order as they always have.
+ * @param candidates
+ */
+void RecommenderSystem::_rankByScore(ScoredMovies &candidates)
+{
+    candidates.order.resize(candidates.scores.size());
+    std::iota(candidates.order.begin(), candidates.order.end(), 0u);
+    const double *scores = candidates.scores.data();
+    std::sort(candidates.order.begin(), candidates.order.end(), [scores](uint32_t lhs,
+                                                                          uint32_t rhs)
+    {
+        return scores[lhs] > scores[rhs];
+    });
+}
+
+/**
+ * @param movie a movie index, or the number of movies for none
+ * @return the name of the movie, empty for none
+ */
+std::string RecommenderSystem::_movieName(size_t movie) const
+{
+    return (movie < _movieNames.size()) ? _movieNames[movie] : std::string();
+}
+
+/**
+ * @return the workers pool, starting it if needed
+ */
+ThreadPool &RecommenderSystem::_threadPool()
+{
+    if (!_pool)
+    {
+        _pool.reset(new ThreadPool());
+    }
+    return *_pool;
+}
+
+/**
+ * @return the rank vector of every client, in the order of _clientNames
+ */
+std::vector<const std::vector<double> *> RecommenderSystem::_rankRows()
+{
+    _unranked.assign(_movieNames.size(), 0.0);
+    std::vector<const std::vector<double> *> ranks;
+    for (const std::string &clientName : _clientNames)
+    {
+        auto client = _clients.find(clientName);
+        ranks.push_back((client == _clients.end()) ? &_unranked : &client->second);
+    }
+    return ranks;
+}
+
+/**
+ * @param user index in _clientNames
+ * @return true if the client is loaded and its line held ranks, as the queries require
+ */
+bool RecommenderSystem::_isClient(size_t user) const
+{
+    return user < _clientRanks.size() && _clientRanks[user] != &_unranked;
+}
+
+/**
+ * @return the attribute vector of every movie, in the order of _movieNames
+ */
+std::vector<const std::vector<double> *> RecommenderSystem::_attributeRows()
+{
+    std::vector<const std::vector<double> *> vectors;
+    for (const std::string &movie : _movieNames)
+    {
+        vectors.push_back(&_movies[movie]);
+    }
+    return vectors;
+}
+
+/**
+ * trains the matrix factorization model on the loaded ranks, which is then used by
+ * predictMovieScoreByMF and recommendByMF. a prediction by the trained model costs O(rank)
+ * per movie, instead of the O(watched movies) of predictMovieScoreForUser.
+ * @param rank length of the latent vector of each client and movie
+ * @param iterations number of alternating least squares iterations
+ * @param lambda regularization weight
+ * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+ */
+int RecommenderSystem::trainMF(int rank, int iterations, double lambda)
+{
+    if (_clientNames.empty())
+    {
+        return BUILD_FAIL;
+    }
+    return _mf.train(_rankRows(), _movieNames.size(), rank, iterations, lambda, _threadPool());
+}
+
+/**
+ * predicts a clients rank to a movie using the model trained by trainMF
+ * @param movieName the movie for which we predict the clients' rank
+ * @param userName client name
+ * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+ * the database or the model is not trained, returns -1
+ */
+double RecommenderSystem::predictMovieScoreByMF(const std::string &movieName,
+                                                const std::string &userName)
+{
+    UserHandle user = lookupUser(userName);
+    auto movie = _movieIds.find(movieName);
+    if (!_mf.isTrained() || user.id == INVALID_HANDLE || movie == _movieIds.end())
+    {
+        return NOT_EXSISTS;
+    }
+    return _mf.predict(user.id, movie->second);
+}
+
+/**
+ * gets the movie with the highest prediction by the model trained by trainMF, between the
+ * movies the client did not watch
+ * @param userName clients name
+ * @return the name of the recommended movie, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendByMF(const std::string &userName)
+{
+    if (lookupUser(userName).id == INVALID_HANDLE)
+    {
+        return INVALID_USER;
+    }
+    std::vector<std::string> best = recommendByMF(userName, 1);
+    return best.empty() ? std::string() : best[0];
+}
+
+/**
+ * gets the n movies with the highest predictions by the model trained by trainMF, between
+ * the movies the client did not watch
+ * @param userName clients name
+ * @param n number of movies to recommend
+ * @return the recommended movies from the best to the worst, empty if the client is not in
+ * the database or the model is not trained
+ */
+std::vector<std::string> RecommenderSystem::recommendByMF(const std::string &userName, int n)
+{
+    std::vector<std::string> out;
+    UserHandle user = lookupUser(userName);
+    if (!_mf.isTrained() || user.id == INVALID_HANDLE || n <= 0)
+    {
+        return out;
+    }
+    for (size_t movie : _mf.topMovies(user.id, *_clientRanks[user.id], n))
+    {
+        out.push_back(_movieNames[movie]);
+    }
+    return out;
+}
+
+/**
+ * finds and caches the k most similar clients of every client, which are then used by
+ * predictMovieScoreByUsers and recommendByUsers
+ * @param k number of neighbors to keep for each client
+ * @return 0 upon success, -1 upon invalid k or when no data was loaded
+ */
+int RecommenderSystem::buildUserNeighbors(int k)
+{
+    if (_clientNames.empty())
+    {
+        return BUILD_FAIL;
+    }
+    return _userNeighbors.build(_rankRows(), _movieNames.size(), k, _threadPool());
+}
+
+/**
+ * predicts a clients rank to a movie from the ranks the clients most similar to them gave
+ * it, using the neighbors found by buildUserNeighbors
+ * @param movieName the movie for which we predict the clients' rank
+ * @param userName client name
+ * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+ * the database or the neighbors are not built, returns -1
+ */
+double RecommenderSystem::predictMovieScoreByUsers(const std::string &movieName,
+                                                   const std::string &userName)
+{
+    UserHandle user = lookupUser(userName);
+    auto movie = _movieIds.find(movieName);
+    if (!_userNeighbors.isBuilt() || user.id == INVALID_HANDLE || movie == _movieIds.end())
+    {
+        return NOT_EXSISTS;
+    }
+    return _userNeighbors.predict(user.id, movie->second);
+}
+
+/**
+ * gets the movie with the highest prediction by predictMovieScoreByUsers, between the movies
+ * the client did not watch
+ * @param userName clients name
+ * @return the name of the recommended movie, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendByUsers(const std::string &userName)
+{
+    UserHandle user = lookupUser(userName);
+    if (user.id == INVALID_HANDLE)
+    {
+        return INVALID_USER;
+    }
+    size_t bestPrediction = _movieNames.size(); // none
+    if (!_userNeighbors.isBuilt())
+    {
+        return _movieName(bestPrediction);
+    }
+    double bestScore = -HUGE_VAL;
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    for (size_t i = 0; i < _movieNames.size(); i++)
+    {
+        if (userRanks[i] == 0.0)
+        {
+            double curScore = _userNeighbors.predict(user.id, i);
+            if (bestScore < curScore)
+            {
+                bestScore = curScore;
+                bestPrediction = i;
+            }
+        }
+    }
+    return _movieName(bestPrediction);
+}
+
+/**
+ * builds the approximate nearest neighbor (hnsw) index of the movie attribute vectors used by
+ * recommendByContentApprox
+ * @param m number of links kept per movie in the graph, at least 2. more links give better
+ * recall for a slower build and search
+ * @param efConstruction number of candidates kept while building
+ * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+ */
+int RecommenderSystem::buildContentIndex(int m, int efConstruction)
+{
+    return _contentIndex.build(_attributeRows(), m, efConstruction);
+}
+
+/**
+ * sets the number of candidates recommendByContentApprox keeps while searching the index.
+ * a bigger ef gives better recall for more latency.
+ * @param ef at least 1
+ */
+void RecommenderSystem::setContentIndexEf(int ef)
+{
+    _contentIndex.setEf(ef);
+}
+
+/**
+ * same as recommendByContent, but searches the index built by buildContentIndex instead of
+ * scanning every movie, so it may miss the best movie. falls back to the exact scan while
+ * the index is not built.
+ * @param userName client name
+ * @return movie recommended upon success, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendByContentApprox(const std::string &userName)
+{
+    UserHandle user = lookupUser(userName);
+    if (user.id == INVALID_HANDLE)
+    {
+        return INVALID_USER;
+    }
+    ArenaScope scope;
+    ArenaVector<double> curNorm = _getNormRankVec(user.id);
+    ArenaVector<double> prefVec = _createPrefVec(user.id, curNorm);
+    if (!_contentIndex.isBuilt() || _norm(prefVec) == 0.0)
+    { // a zero preference vector has no direction to search towards
+        return _movieName(_findMovieByPref<CosineSimilarity>(user.id, prefVec).movie);
+    }
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    std::vector<double> query(prefVec.begin(), prefVec.end());
+    std::vector<std::pair<double, size_t> > found =
+            _contentIndex.search(query, 1, [&userRanks](size_t movie)
+            {
+                return userRanks[movie] == 0.0;
+            });
+    return found.empty() ? std::string() : _movieNames[found[0].second];
+}
+
+/**
+ * clusters the movie attribute vectors, so that recommendByContent can skip whole clusters
+ * that provably cannot contain a better movie than the best one found so far. the
+ * recommendations stay identical to the full scan.
+ * @param clusters number of clusters, about the square root of the number of movies works well
+ * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+ */
+int RecommenderSystem::buildContentClusters(int clusters)
+{
+    return _contentClusters.build(_attributeRows(), clusters);
+}
+
+/**
+ * computes the random hyperplane lsh signatures of every movie, used as a cheap candidate
+ * filter by recommendByContentLsh and predictMovieScoreForUserLsh
+ * @param tables number of signatures per movie, more tables estimate the angles better
+ * @param bits number of hyperplanes per signature, between 1 and 64
+ * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+ */
+int RecommenderSystem::buildLsh(int tables, int bits)
+{
+    return _lsh.build(_attributeRows(), tables, bits);
+}
+
+/**
+ * same as recommendByContent, but scores only the unwatched movies whose lsh signatures are
+ * closest to the signature of the client's preference vector
+ * @param userName client name
+ * @param candidates number of movies to score exactly
+ * @return movie recommended upon success, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendByContentLsh(const std::string &userName, int candidates)
+{
+    UserHandle user = lookupUser(userName);
+    if (user.id == INVALID_HANDLE)
+    {
+        return INVALID_USER;
+    }
+    ArenaScope scope;
+    ArenaVector<double> curNorm = _getNormRankVec(user.id);
+    ArenaVector<double> prefVec = _createPrefVec(user.id, curNorm);
+    double prefNorm = _norm(prefVec);
+    if (!_lsh.isBuilt() || prefNorm == 0.0)
+    {
+        return _movieName(_findMovieByPref<CosineSimilarity>(user.id, prefVec).movie);
+    }
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    std::vector<double> query(prefVec.begin(), prefVec.end());
+    std::vector<size_t> found = _lsh.candidates(_lsh.signature(query).data(),
+                                                std::max(candidates, 1),
+                                                [&userRanks](size_t movie)
+                                                {
+                                                    return userRanks[movie] == 0.0;
+                                                });
+    size_t closest = _movieNames.size(); // none
+    double closestScore = -HUGE_VAL;
+    for (size_t i : found)
+    { // exact re-ranking, the earlier movie wins a tie like in the full scan
+        const std::vector<double> &movie = *_movieAttributes[i];
+        double curScore = _dotProd(movie, prefVec) / (_norm(movie) * prefNorm);
+        if (curScore > closestScore || (curScore == closestScore && i < closest))
+        {
+            closestScore = curScore;
+            closest = i;
+        }
+    }
+    return _movieName(closest);
+}
+
+/**
+ * same as predictMovieScoreForUser, but looks for the k closest movies only between the
+ * ranked movies whose lsh signatures are closest to the signature of the predicted movie
+ * @param movieName the movie for which we predict the clients' rank
+ * @param userName client name
+ * @param k
+ * @param candidates number of ranked movies to score exactly, at least k are scored
+ * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+ * the database or the signatures are not built, returns -1
+ */
+double RecommenderSystem::predictMovieScoreForUserLsh(const std::string &movieName,
+                                                      const std::string &userName, int k,
+                                                      int candidates)
+{
+    UserHandle user = lookupUser(userName);
+    auto movie = _movieIds.find(movieName);
+    if (!_lsh.isBuilt() || user.id == INVALID_HANDLE || movie == _movieIds.end())
+    {
+        return NOT_EXSISTS;
+    }
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    std::vector<size_t> found = _lsh.candidates(_lsh.movieSignature(movie->second),
+                                                std::max(candidates, k),
+                                                [&userRanks](size_t i)
+                                                {
+                                                    return userRanks[i] != 0.0;
+                                                });
+    ArenaScope scope;
+    ArenaVector<size_t> clientHistory(found.begin(), found.end());
+    std::sort(clientHistory.begin(), clientHistory.end(), [this](size_t lhs, size_t rhs)
+    { // the order of the users ratings by movie name
+        return _movieNames[lhs] < _movieNames[rhs];
+    });
+    ScoredMovies sorted = _findMovieByHistory<CosineSimilarity>(*_movieAttributes[movie->second],
+                                                                 clientHistory);
+    double numerator = 0.0;
+    double denominator = 0.0;
+    for (size_t i = 0; i < sorted.size() && i < (size_t) k; i++)
+    {
+        resMovie closest = sorted[i];
+        numerator += closest.score * userRanks[closest.movie];
+        denominator += closest.score;
+    }
+    return numerator / denominator;
+}
+
+/**
+ * precomputes for every movie the m movies most similar to it, from the most similar to the
+ * least. predictMovieScoreForUser (and so recommendByCF) then walks the list of the
+ * predicted movie until it finds k movies the client ranked, and falls back to sorting the
+ * client's whole history only when the list holds fewer than k of them.
+ * @param m length of each list
+ * @param quantized if true and buildQuantizedAttributes was called, the lists are picked
+ * with the 8 bit kernels and only the shortlisted pairs are scored in double. this is
+ * faster to build, but a movie near the end of a list may differ from the exact build.
+ * @return 0 upon success, -1 upon invalid m or when no data was loaded
+ */
+int RecommenderSystem::buildMovieNeighbors(int m, bool quantized)
+{
+    return _movieNeighbors.build(_attributeRows(), m, _threadPool(),
+                                 (quantized && _quantized.isBuilt()) ? &_quantized : nullptr);
+}
+
+/**
+ * computes the cosine similarity of every pair of movies and streams it to a file, tile by
+ * tile, so catalogs whose similarity matrix does not fit in memory can still be precomputed.
+ * see SimilarityTiles::readFile for reading it back.
+ * @param path the file to write
+ * @return 0 upon success, -1 when no data was loaded or the file cannot be written
+ */
+int RecommenderSystem::writeMovieSimilarities(const std::string &path)
+{
+    return SimilarityTiles().toFile(_attributeRows(), _threadPool(), path);
+}
+
+/**
+ * builds a sparse graph of the movie similarities, keeping for every movie only the movies whose
+ * similarity with it reaches the threshold, and of those at most the m closest, with 16 bit
+ * float weights. predictMovieScoreForUser (and so recommendByCF) then walks the list of the
+ * predicted movie like the neighbor lists of buildMovieNeighbors, and falls back to the exact
+ * computation when fewer than k ranked movies survived the pruning. its memory grows with the
+ * kept edges, not with the square of the catalog.
+ * @param threshold the lowest similarity kept, -1 keeps every similarity
+ * @param m the most neighbors kept per movie, 0 for no limit
+ * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+ */
+int RecommenderSystem::buildSimilarityGraph(double threshold, int m)
+{
+    return _similarityGraph.build(_attributeRows(), threshold, m, _threadPool());
+}
+
+/**
+ * builds the 8 bit copy of the movie attributes used by recommendByContentQuantized and by
+ * buildMovieNeighbors. it takes a quarter of the memory of the double attributes.
+ * @return 0 upon success, -1 when no data was loaded or an attribute is negative
+ */
+int RecommenderSystem::buildQuantizedAttributes()
+{
+    return _quantized.build(_attributeRows());
+}
+
+/**
+ * same as recommendByContent, but scores the movies with integer dot products on the 8 bit
+ * attributes built by buildQuantizedAttributes, so close scores may be ordered differently.
+ * falls back to the exact scan while the attributes are not built.
+ * @param userName client name
+ * @return movie recommended upon success, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendByContentQuantized(const std::string &userName)
+{
+    UserHandle user = lookupUser(userName);
+    if (user.id == INVALID_HANDLE)
+    {
+        return INVALID_USER;
+    }
+    ArenaScope scope;
+    ArenaVector<double> curNorm = _getNormRankVec(user.id);
+    ArenaVector<double> prefVec = _createPrefVec(user.id, curNorm);
+    if (!_quantized.isBuilt())
+    {
+        return _movieName(_findMovieByPref<CosineSimilarity>(user.id, prefVec).movie);
+    }
+    std::vector<int8_t> query;
+    double queryNorm = _quantized.quantizeQuery(std::vector<double>(prefVec.begin(),
+                                                                    prefVec.end()), query);
+    const std::vector<double> &userRanks = *_clientRanks[user.id];
+    size_t closest = _movieNames.size(); // none
+    double closestScore = -HUGE_VAL;
+    for (size_t i = 0; i < _movieNames.size(); i++)
+    {
+        if (userRanks[i] == 0.0)
+        {
+            double curScore = _quantized.cosine(i, query, queryNorm);
+            if (curScore > closestScore)
+            {
+                closestScore = curScore;
+                closest = i;
+            }
+        }
+    }
+    return _movieName(closest);
+}
+
+/**
+ * builds a flat float copy of the movie attributes and the client ranks, used by
+ * recommendByContentFloat, predictMovieScoreForUserFloat and recommendByCFFloat. the copy
+ * is kept next to the double data, adding about half its size to the memory held; in return
+ * the float scans read half the bytes of the double ones.
+ * @return 0 upon success, -1 when no data was loaded
+ */
+int RecommenderSystem::buildFloatModel()
+{
+    return _floatModel.build(_attributeRows(), _rankRows());
+}
+
+/**
+ * same as recommendByContent, computed in float on the model built by buildFloatModel, so
+ * close scores may be ordered differently. falls back to recommendByContent while the model
+ * is not built.
+ * @param userName client name
+ * @return movie recommended upon success, invalid client name message upon failure
+ */
+std::string RecommenderSystem::recommendByContentFloat(const std::string &userName)
+{
+    UserHandle client = lookupUser(userName);
+    if (!_floatModel.isBuilt() || client.id == INVALID_HANDLE)
+    {
+        return recommendByContent(userName);
+    }
+    long movie = _floatModel.recommendByContent(client.id);
+    return (movie < 0) ? std::string() : _movieNames[movie];
+}
+
+/**
+ * same as predictMovieScoreForUser, computed in float on the model built by
+ * buildFloatModel. falls back to predictMovieScoreForUser while the model is not built.
+ * @param movieName the movie for which we predict the clients' rank
+ * @param userName client name
+ * @param k
+ * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+ * the database, returns -1
+ */
+double RecommenderSystem::predictMovieScoreForUserFloat(const std::string &movieName,
+                                                        const std::string &userName, int k)
+{
+    UserHandle client = lookupUser(userName);
+    auto movie = _movieIds.find(movieName);
+    if (!_floatModel.isBuilt() || client.id == INVALID_HANDLE || movie == _movieIds.end())
+    {
+        return predictMovieScoreForUser(movieName, userName, k);
+    }
+    return _floatModel.predict(movie->second, client.id, k);
+}
+
+/**
+ * same as recommendByCF, computed in float on the model built by buildFloatModel. falls
+ * back to recommendByCF while the model is not built.
+ * @param userName clients name
+ * @param k
+ * @return the name of the movie for which our prediction is the highest
+ */
+std::string RecommenderSystem::recommendByCFFloat(const std::string &userName, int k)
+{
+    UserHandle client = lookupUser(userName);
+    if (!_floatModel.isBuilt() || client.id == INVALID_HANDLE)
+    {
+        return recommendByCF(userName, k);
+    }
+    long movie = _floatModel.recommendByCF(client.id, k);
+    return (movie < 0) ? std::string() : _movieNames[movie];
 }
 
+// the similarity metrics the public algorithms are compiled for
+#define INSTANTIATE_SIMILARITY(Similarity) \
+    template std::string RecommenderSystem::recommendByContent<Similarity>( \
+            const std::string &userName); \
+    template double RecommenderSystem::predictMovieScoreForUser<Similarity>( \
+            const std::string &movieName, const std::string &userName, int k); \
+    template std::string RecommenderSystem::recommendByCF<Similarity>( \
+            const std::string &userName, int k); \
+    template std::string RecommenderSystem::recommendByContent<Similarity>(UserHandle user); \
+    template double RecommenderSystem::predictMovieScoreForUser<Similarity>( \
+            MovieHandle movie, UserHandle user, int k); \
+    template std::string RecommenderSystem::recommendByCF<Similarity>(UserHandle user, int k);
 
+INSTANTIATE_SIMILARITY(CosineSimilarity)
+INSTANTIATE_SIMILARITY(AdjustedCosineSimilarity)
+INSTANTIATE_SIMILARITY(PearsonSimilarity)
+INSTANTIATE_SIMILARITY(DotProductSimilarity)
+INSTANTIATE_SIMILARITY(EuclideanSimilarity)
@@ -6,99 +6,361 @@
 #define EX5_RECOMMENDERSYSTEM_H
 
 #define NOT_EXSISTS -1
+#define INVALID_HANDLE ((size_t) -1)
 
 #include <vector>
 #include <numeric>
 #include <iostream>
 #include <string>
 #include <map>
+#include <memory>
+#include <cstdint>
+#include <exception>
+#include "ThreadPool.h"
+#include "VectorMath.h"
+#include "MatrixFactorization.h"
+#include "UserNeighbors.h"
+#include "HnswIndex.h"
+#include "MovieClusters.h"
+#include "CosineLsh.h"
+#include "MovieNeighbors.h"
+#include "Similarity.h"
+#include "DenseModel.h"
+#include "AttributeIndex.h"
+#include "MovieRaters.h"
+#include "SimilarityTiles.h"
+#include "SimilarityGraph.h"
+#include "Snapshot.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "RecommenderEngine.h"
+#include "QueryArena.h"
 
 /**
- * a struct contains a movie name and it's resemblance score
+ * a struct contains a movie index (in the movie list of the ranks file) and it's resemblance
+ * score. the name is only looked up when a query returns it.
  */
-typedef struct {double score; std::string name; } resMovie;
+typedef struct {double score; size_t movie; } resMovie;
+
+/**
+ * scored candidate movies of a query in struct of arrays form: the scores and the movie indices
+ * in parallel arrays of the query arena, so ranking them reads 8 byte scores and moves 4 byte
+ * positions instead of whole records
+ */
+struct ScoredMovies
+{
+    ArenaVector<double> scores;
+    ArenaVector<uint32_t> movies;
+    ArenaVector<uint32_t> order; // positions in the arrays from the best score, once ranked
+
+    /**
+     * @param i
+     * @return the candidate ranked i'th
+     */
+    resMovie operator[](size_t i) const
+    {
+        resMovie out = {.score = scores[order[i]], .movie = movies[order[i]]};
+        return out;
+    }
+
+    /**
+     * @return the number of candidates
+     */
+    size_t size() const
+    {
+        return scores.size();
+    }
+};
+
+/**
+ * a client resolved once by lookupUser, for callers that query the same clients at a high rate.
+ * id is the client's index in the order of the ranks file lines, or INVALID_HANDLE if there is
+ * no such client or its line holds no ranks. valid as long as the loaded data is.
+ */
+struct UserHandle
+{
+    size_t id;
+};
+
+/**
+ * a movie resolved once by lookupMovie. id is the movie's index in the movie list of the ranks
+ * file, or INVALID_HANDLE if there is no such movie. valid as long as the loaded data is.
+ */
+struct MovieHandle
+{
+    size_t id;
+};
 
 /**
  * the class of our recommendation system
  */
-class RecommenderSystem
+class RecommenderSystem : public RecommenderEngine
 {
 private:
     std::vector<std::string> _movieNames; // in the order of the rank file movie list
     std::map<std::string, std::vector<double> > _clients; // clients and their past rankings
     std::map<std::string, int > _clientsRanksNum; // number of movies watched by each client
     std::map<std::string, std::vector<double> > _movies; // movies and their attribute rankings
+    std::map<std::string, size_t> _movieIds; // index of each movie in _movieNames
+    std::vector<std::string> _clientNames; // in the order of the rank file client lines
+    std::map<std::string, size_t> _clientIds; // index of each client in _clientNames
+    // the state the queries read by index, derived by _finishLoad
+    std::vector<const std::vector<double> *> _clientRanks; // by _clientNames, from _clients
+    std::vector<int> _clientRankCounts; // by _clientNames, from _clientsRanksNum
+    std::vector<double> _unranked; // the row of the clients whose lines hold no ranks, all NA
+    std::vector<const std::vector<double> *> _movieAttributes; // by _movieNames, from _movies
+    std::vector<size_t> _moviesByName; // the indices of _movieNames, by the order of the names
+    MatrixFactorization _mf; // low rank model of the ranks, trained on demand by trainMF
+    UserNeighbors _userNeighbors; // similar clients of each client, built by buildUserNeighbors
+    HnswIndex _contentIndex; // approximate index of the movies, built by buildContentIndex
+    MovieClusters _contentClusters; // exact pruning of the content scan, see buildContentClusters
+    CosineLsh _lsh; // bit signatures of the movie attributes, built by buildLsh
+    MovieNeighbors _movieNeighbors; // most similar movies of each movie, see buildMovieNeighbors
+    SimilarityGraph _similarityGraph; // pruned movie similarities, see buildSimilarityGraph
+    QuantizedAttributes _quantized; // 8 bit movie attributes, built by buildQuantizedAttributes
+    DenseModel<float> _floatModel; // float copy of the attributes and ranks, see buildFloatModel
+    AttributeIndex _attributeIndex; // bitmaps of the attribute values, see buildAttributeIndex
+    MovieRaters _movieRaters; // the ranks by movie, built by buildMovieRaters
+    std::unique_ptr<ThreadPool> _pool; // workers for the model builders, started on first use
+    VectorMath::ExactKernels _kernels = VectorMath::exactKernelsFor(0); // picked by loadData
+    /**
+     * @return the workers pool, starting it if needed
+     */
+    ThreadPool &_threadPool();
+    /**
+     * @return the rank vector of every client, in the order of _clientNames; the clients whose
+     * lines hold no ranks share _unranked
+     */
+    std::vector<const std::vector<double> *> _rankRows();
+    /**
+     * @param user index in _clientNames
+     * @return true if the client is loaded and its line held ranks, as the queries require
+     */
+    bool _isClient(size_t user) const;
+    /**
+     * @return the attribute vector of every movie, in the order of _movieNames
+     */
+    std::vector<const std::vector<double> *> _attributeRows();
+    std::vector<double> _attributeMeans; // average of each attribute over all the movies
+    /**
+     * @return what the similarity metrics need to know about the loaded data
+     */
+    SimilarityContext _similarityContext() const;
     /**
      * finds the best movie to recommend based on the users' preference vector of movie attributes
-     * @param user clients' name
+     * @tparam Similarity the similarity metric, see Similarity.h
+     * @param user clients' index
      * @param prefVec clients' preference vector
-     * @return a resMovie struct, contains the recommended movie's name and resemblance score
+     * @return a resMovie struct, contains the recommended movie's index and resemblance score,
+     * the index is the number of movies if the client watched them all
      */
-    resMovie _findMovieByPref(const std::string &user, const std::vector<double> &prefVec);
+    template<class Similarity>
+    resMovie _findMovieByPref(size_t user, const ArenaVector<double> &prefVec);
     /**
-     * helper method which calculate the norm of a given vector
+     * helper method which calculate the norm of a given vector, with the kernel
+     * specialized for the attribute count when the length matches it
+     * @tparam Alloc the allocator of the vector, for the query temporaries of the arena
      * @param vec
      * @return the norm of vec
      */
-    static double _norm(const std::vector<double> &vec);
+    template<class Alloc>
+    double _norm(const std::vector<double, Alloc> &vec) const;
     /**
-     * helper method which calculate the dot product of two vectors
+     * helper method which calculate the dot product of two vectors, with the kernel
+     * specialized for the attribute count when the length matches it
+     * @tparam AllocA the allocator of a
+     * @tparam AllocB the allocator of b
      * @param a first vector
      * @param b second vector
      * @return the dot product
      */
-    static double _dotProd(const std::vector<double> &a, const std::vector<double> &b);
+    template<class AllocA, class AllocB>
+    double _dotProd(const std::vector<double, AllocA> &a,
+                    const std::vector<double, AllocB> &b) const;
     /**
      * creates the preference vector of a given client based on past ranks and movie attributes
-     * @param user client name
+     * @param user client index
      * @param curNorm normalized preference vector of the client
-     * @return the clients preference vector
+     * @return the clients preference vector, in the arena of the query
      */
-    std::vector<double> _createPrefVec(const std::string &user, const std::vector<double> &curNorm);
+    ArenaVector<double> _createPrefVec(size_t user, const ArenaVector<double> &curNorm);
     /**
      * helper method to calculate the normalized ranks vector of a given client
-     * @param user client name
-     * @return the normalized preference vector of the client
+     * @param user client index
+     * @return the normalized preference vector of the client, in the arena of the query
      */
-    std::vector<double> _getNormRankVec(const std::string &user);
+    ArenaVector<double> _getNormRankVec(size_t user);
     /**
      * creates a vector of past ranked movies, sorted by resemblance to certain movie attributes,
      * from the closest to the most different one
+     * @tparam Similarity the similarity metric, see Similarity.h
      * @param movieAttributes the movie attributes according to which we sort
-     * @param userHistory a map of the clients' past movies and their rankings
-     * @return the sorted vector of past ranked movies in the above mentioned order
+     * @param userHistory the indices of the clients' past movies, by the order of their names
+     * @return the past ranked movies ranked in the above mentioned order, in the arena of the query
      */
-    std::vector<resMovie> _findMovieByHistory(const std::vector<double> &movieAttributes,
-                                              const std::map<std::string, double> &userHistory);
+    template<class Similarity>
+    ScoredMovies _findMovieByHistory(const std::vector<double> &movieAttributes,
+                                     const ArenaVector<size_t> &userHistory);
     /**
-     * comperator function for the resMovie struct, based on the movies' score.
-     * @param lhs
-     * @param rhs
-     * @return the bool value of the statement lhs.score > rhs.score
+     * the prediction of predictMovieScoreForUser, for a client and movie already resolved
+     * @tparam Similarity the similarity metric, see Similarity.h
+     * @param movieAttributes the attributes of the movie we predict for
+     * @param movie its index, or the number of movies if it is not in the ranks file
+     * @param user client index
+     * @param k
+     * @return the prediction of the clients' rank to the movie
      */
-    static bool _compResMovie(const resMovie &lhs, const resMovie &rhs);
+    template<class Similarity>
+    double _predictForUser(const std::vector<double> &movieAttributes, size_t movie, size_t user,
+                           int k);
     /**
-     * helper method, updates user's rank vector according to the input file
-     * @param i number of the watched movies so far + 1
-     * @param clientName
-     * @param val current movie rank parsed from the file
+     * the movies a client ranked, for predictions that skip the history map. a query
+     * temporary, in the arena of the query.
      */
-    void _updateUserRank(int &i, const std::string &clientName, const std::string &val);
+    struct RankedHistory
+    {
+        ArenaVector<size_t> movies; // the ranked movies, by index
+        ArenaVector<double> norms; // the attribute norm of each ranked movie
+        ArenaVector<std::pair<double, size_t> > scored; // scratch space of _predictByRanked
+    };
+    /**
+     * lists the movies a client ranked with their attribute norms
+     * @param userRanks the client's rank vector
+     * @param movies the attribute vector of every movie, in the order of _movieNames
+     * @return the ranked movies, ready for _predictByRanked
+     */
+    RankedHistory _rankedHistory(const std::vector<double> &userRanks,
+                                 const std::vector<const std::vector<double> *> &movies) const;
+    /**
+     * the prediction of predictMovieScoreForUser by the precomputed lists of similar movies: the
+     * neighbor lists of buildMovieNeighbors, or else the graph of buildSimilarityGraph
+     * @param movie the predicted movie
+     * @param userRanks the client's rank vector
+     * @param k
+     * @param prediction output, the prediction if found
+     * @return true if a built list of the movie holds k movies the client ranked
+     */
+    bool _predictByLists(size_t movie, const std::vector<double> &userRanks, int k,
+                         double &prediction) const;
+    /**
+     * the prediction of predictMovieScoreForUser, by the precomputed lists when they are built,
+     * and otherwise by picking the k closest ranked movies with a partial sort instead of
+     * sorting the whole history
+     * @param movie the predicted movie
+     * @param movieNorm the norm of its attributes
+     * @param userRanks the client's rank vector
+     * @param movies the attribute vector of every movie, in the order of _movieNames
+     * @param k
+     * @param history the client's ranked movies, from _rankedHistory
+     * @return the prediction
+     */
+    double _predictByRanked(size_t movie, double movieNorm, const std::vector<double> &userRanks,
+                            const std::vector<const std::vector<double> *> &movies, int k,
+                            RankedHistory &history) const;
+    /**
+     * the unwatched movies of a client that pass the filters, as a bitmap. the filters are
+     * applied by the bitmap index when buildAttributeIndex was called, and by the attribute
+     * vectors otherwise.
+     * @param userRanks the client's rank vector
+     * @param filters
+     * @return bit i of word i / 64 is set if movie i is a candidate, in the arena of the query
+     */
+    ArenaVector<uint64_t> _filteredUnwatched(const std::vector<double> &userRanks,
+                                             const std::vector<AttributeFilter> &filters);
+    /**
+     * orders scored movies from the highest score to the lowest, ties going to the lower index,
+     * and keeps the names of the first n
+     * @param scored pairs of score and movie index
+     * @param n
+     * @return the names of the n best movies
+     */
+    std::vector<std::string> _topNames(ArenaVector<std::pair<double, size_t> > &scored,
+                                       int n) const;
+    /**
+     * ranks the candidates by their score alone, from the highest. sorts their positions with
+     * the comparisons a sort of whole records would make, so tied candidates end up in the
+     * same order as they always have.
+     * @param candidates
+     */
+    static void _rankByScore(ScoredMovies &candidates);
+    /**
+     * @param movie a movie index, or the number of movies for none
+     * @return the name of the movie, empty for none
+     */
+    std::string _movieName(size_t movie) const;
+    /**
+     * the client lines of one chunk of the ranks file, parsed apart from the other chunks
+     */
+    struct RanksChunk
+    {
+        std::vector<std::string> names; // the client of each line
+        std::vector<std::vector<double> > ranks; // the ranks of each line, 0 for NA
+        std::vector<int> ranked; // the number of movies each line ranked
+        bool failed = false; // the line after the parsed ones has no client name
+        std::exception_ptr error; // thrown by the line after the parsed ones, if any
+    };
+    /**
+     * helper method, parses the lines of the movie attributes file into _movies
+     * @param movies the open file
+     * @return 0 upon success, -1 upon a line without a movie name
+     */
+    int _parseMovies(std::istream &movies);
+    /**
+     * helper method, parses the client lines that start in a byte range of the ranks file. the
+     * ranges of the chunks may cut lines anywhere, each line is parsed by the chunk it starts in.
+     * @param path the ranks file
+     * @param begin first byte of the range
+     * @param end the byte after the range
+     * @param chunk output, the parsed lines, up to the first invalid one
+     */
+    static void _parseRanksChunk(const std::string &path, size_t begin, size_t end,
+                                 RanksChunk &chunk);
+    /**
+     * helper method, adds the parsed client lines of a chunk to the clients, as if the lines
+     * were read one after the other
+     * @param chunk moved from
+     * @return 0 upon success, -1 if the chunk stopped at a line without a client name
+     */
+    int _mergeRanksChunk(RanksChunk &chunk);
+    /**
+     * helper method, derives the state shared by every query from the loaded movies
+     * @return 0 upon success, -1 if a movie of the ranks has no attributes or the movies have
+     * different numbers of attributes
+     */
+    int _finishLoad();
 public:
+    /**
+     * @return "reference", the name of this implementation
+     */
+    std::string engineName() const override;
     /**
      * a function which loads data from movie attributes file and clients rank history
      * @param moviesAttributesFilePath
      * @param userRanksFilePath
      * @return 0 upon success, -1 upon failure
      */
-    int loadData(const std::string &moviesAttributesFilePath, const std::string &userRanksFilePath);
+    int loadData(const std::string &moviesAttributesFilePath,
+                 const std::string &userRanksFilePath) override;
+    /**
+     * loads the movies and clients from a binary snapshot, written by saveSnapshot or the dataset
+     * generator, instead of the text files
+     * @param snapshotFilePath
+     * @return 0 upon success, -1 upon failure
+     */
+    int loadSnapshot(const std::string &snapshotFilePath);
+    /**
+     * writes the loaded movies and clients as a binary snapshot, for loadSnapshot
+     * @param snapshotFilePath
+     * @return 0 upon success, -1 upon failure
+     */
+    int saveSnapshot(const std::string &snapshotFilePath);
     /**
      * implementation of the content based algorithm, which uses existing ranks if movies and their
      * attributes to recommend a movie to the client
      * @param userName client name
      * @return movie recommended upon success, invalid client name message upon failure
      */
-    std::string recommendByContent(const std::string &userName);
+    std::string recommendByContent(const std::string &userName) override;
     /**
      * predicts a clients rank to a movie they didn't watch based on past rankings of the k movies
      * with attributes closest to the movie we want to predict for. using the scoring method
@@ -109,7 +371,8 @@ public:
      * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
      * the database, returns -1
      */
-    double predictMovieScoreForUser(const std::string &movieName, const std::string &userName, int k);
+    double predictMovieScoreForUser(const std::string &movieName, const std::string &userName,
+                                    int k) override;
     /**
      * gets the best movie to recommend to the client by predicting users rank to the movies they did
      * not watch already and saving the best scoring movie between those. prediction is based on the
@@ -118,7 +381,367 @@ public:
      * @param k
      * @return the name of the movie for which our prediction is the highest
      */
+    std::string recommendByCF(const std::string &userName, int k) override;
+    /**
+     * recommendByContent with another similarity metric in place of the cosine similarity,
+     * e.g. rs.recommendByContent<PearsonSimilarity>(userName). the metric is picked at compile
+     * time, see Similarity.h for the available ones.
+     * @tparam Similarity the similarity metric
+     * @param userName client name
+     * @return movie recommended upon success, invalid client name message upon failure
+     */
+    template<class Similarity>
+    std::string recommendByContent(const std::string &userName);
+    /**
+     * predictMovieScoreForUser with another similarity metric in place of the cosine
+     * similarity. the metric is picked at compile time, see Similarity.h for the available ones.
+     * @tparam Similarity the similarity metric
+     * @param movieName the movie for which we predict the clients' rank
+     * @param userName client name
+     * @param k
+     * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+     * the database, returns -1
+     */
+    template<class Similarity>
+    double predictMovieScoreForUser(const std::string &movieName, const std::string &userName,
+                                    int k);
+    /**
+     * recommendByCF with another similarity metric in place of the cosine similarity. the
+     * metric is picked at compile time, see Similarity.h for the available ones.
+     * @tparam Similarity the similarity metric
+     * @param userName clients name
+     * @param k
+     * @return the name of the movie for which our prediction is the highest
+     */
+    template<class Similarity>
     std::string recommendByCF(const std::string &userName, int k);
+    /**
+     * resolves a client name once, for the handle overloads of the queries
+     * @param userName client name
+     * @return the client's handle, with the id INVALID_HANDLE if there is no such client or its
+     * line holds no ranks
+     */
+    UserHandle lookupUser(const std::string &userName) const;
+    /**
+     * resolves a movie name once, for the handle overloads of the queries
+     * @param movieName movie name
+     * @return the movie's handle, with the id INVALID_HANDLE if the movie is not in the ranks
+     * file or has no attributes
+     */
+    MovieHandle lookupMovie(const std::string &movieName) const;
+    /**
+     * recommendByContent for a client resolved by lookupUser, skipping the name lookups
+     * @param user
+     * @return movie recommended upon success, invalid client name message upon failure
+     */
+    std::string recommendByContent(UserHandle user);
+    /**
+     * predictMovieScoreForUser for a movie and client resolved by lookupMovie and lookupUser,
+     * skipping the name lookups
+     * @param movie
+     * @param user
+     * @param k
+     * @return the prediction of the clients' rank to the movie, -1 for an invalid handle
+     */
+    double predictMovieScoreForUser(MovieHandle movie, UserHandle user, int k);
+    /**
+     * recommendByCF for a client resolved by lookupUser, skipping the name lookups
+     * @param user
+     * @param k
+     * @return the name of the movie for which our prediction is the highest
+     */
+    std::string recommendByCF(UserHandle user, int k);
+    /**
+     * the handle overload of recommendByContent with another similarity metric
+     * @tparam Similarity the similarity metric
+     * @param user
+     * @return movie recommended upon success, invalid client name message upon failure
+     */
+    template<class Similarity>
+    std::string recommendByContent(UserHandle user);
+    /**
+     * the handle overload of predictMovieScoreForUser with another similarity metric
+     * @tparam Similarity the similarity metric
+     * @param movie
+     * @param user
+     * @param k
+     * @return the prediction of the clients' rank to the movie, -1 for an invalid handle
+     */
+    template<class Similarity>
+    double predictMovieScoreForUser(MovieHandle movie, UserHandle user, int k);
+    /**
+     * the handle overload of recommendByCF with another similarity metric
+     * @tparam Similarity the similarity metric
+     * @param user
+     * @param k
+     * @return the name of the movie for which our prediction is the highest
+     */
+    template<class Similarity>
+    std::string recommendByCF(UserHandle user, int k);
+    /**
+     * blends the content based and the cf algorithms into one ranking, scoring every unwatched
+     * movie by weight * c + (1 - weight) * p / maxRank, where c is the cosine of the movie and
+     * the client's preference vector (as in recommendByContent), p is the prediction of
+     * predictMovieScoreForUser and maxRank is the client's highest rank. both scores come out of
+     * a single pass over the unwatched movies, which shares the preference vector, the ranked
+     * movies and the attribute norms between them.
+     * @param userName client name
+     * @param k the k of the cf prediction
+     * @param weight weight of the content score, between 0 (cf only) and 1 (content only)
+     * @return the movie with the highest blended score, invalid client name message upon failure
+     */
+    std::string recommendHybrid(const std::string &userName, int k, double weight);
+    /**
+     * builds the bitmap indexes of the movie attributes, which the filtered recommendByContent
+     * and recommendByCF then intersect with the unwatched movies before scoring any movie
+     * @return 0 upon success, -1 when no data was loaded
+     */
+    int buildAttributeIndex();
+    /**
+     * the n best movies of the content based algorithm, between the unwatched movies that pass
+     * all the filters. only those movies are scored.
+     * @param userName client name
+     * @param filters conditions on the movie attributes, e.g. {2, 7.0, HUGE_VAL} for attribute
+     * 2 at least 7
+     * @param n number of movies to recommend
+     * @return the recommended movies from the best to the worst, empty if the client is not in
+     * the database
+     */
+    std::vector<std::string> recommendByContent(const std::string &userName,
+                                                const std::vector<AttributeFilter> &filters,
+                                                int n);
+    /**
+     * the n movies with the highest cf predictions, between the unwatched movies that pass all
+     * the filters. only those movies are predicted.
+     * @param userName client name
+     * @param k the k of the prediction
+     * @param filters conditions on the movie attributes
+     * @param n number of movies to recommend
+     * @return the recommended movies from the best to the worst, empty if the client is not in
+     * the database
+     */
+    std::vector<std::string> recommendByCF(const std::string &userName, int k,
+                                           const std::vector<AttributeFilter> &filters, int n);
+    /**
+     * builds the movie major copy of the ranks used by topUsersForMovie, and starts the workers
+     * that predict from it, so the queries only read them
+     * @return 0 upon success, -1 when no data was loaded
+     */
+    int buildMovieRaters();
+    /**
+     * @return true once the workers were started, by loadData for a ranks file of a few chunks
+     * or by a builder. the work they do is not seen by the counters of the calling thread
+     */
+    bool workersStarted() const;
+    /**
+     * the n clients with the highest predictions of predictMovieScoreForUser for a movie,
+     * between the clients who did not rank it. all the clients are predicted in one parallel
+     * pass over the movie major copy of buildMovieRaters, instead of a history map and a sort
+     * per client.
+     * @param movieName the movie to find an audience for
+     * @param k the k of the prediction
+     * @param n number of clients to return
+     * @return the clients from the highest prediction to the lowest, empty if the movie is not in
+     * the database or buildMovieRaters was not called
+     */
+    std::vector<std::string> topUsersForMovie(const std::string &movieName, int k, int n);
+    /**
+     * trains the matrix factorization model on the loaded ranks, which is then used by
+     * predictMovieScoreByMF and recommendByMF. a prediction by the trained model costs O(rank)
+     * per movie, instead of the O(watched movies) of predictMovieScoreForUser.
+     * @param rank length of the latent vector of each client and movie
+     * @param iterations number of alternating least squares iterations
+     * @param lambda regularization weight
+     * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+     */
+    int trainMF(int rank, int iterations, double lambda);
+    /**
+     * predicts a clients rank to a movie using the model trained by trainMF
+     * @param movieName the movie for which we predict the clients' rank
+     * @param userName client name
+     * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+     * the database or the model is not trained, returns -1
+     */
+    double predictMovieScoreByMF(const std::string &movieName, const std::string &userName);
+    /**
+     * gets the movie with the highest prediction by the model trained by trainMF, between the
+     * movies the client did not watch
+     * @param userName clients name
+     * @return the name of the recommended movie, invalid client name message upon failure
+     */
+    std::string recommendByMF(const std::string &userName);
+    /**
+     * gets the n movies with the highest predictions by the model trained by trainMF, between
+     * the movies the client did not watch
+     * @param userName clients name
+     * @param n number of movies to recommend
+     * @return the recommended movies from the best to the worst, empty if the client is not in
+     * the database or the model is not trained
+     */
+    std::vector<std::string> recommendByMF(const std::string &userName, int n);
+    /**
+     * finds and caches the k most similar clients of every client, which are then used by
+     * predictMovieScoreByUsers and recommendByUsers
+     * @param k number of neighbors to keep for each client
+     * @return 0 upon success, -1 upon invalid k or when no data was loaded
+     */
+    int buildUserNeighbors(int k);
+    /**
+     * predicts a clients rank to a movie from the ranks the clients most similar to them gave
+     * it, using the neighbors found by buildUserNeighbors
+     * @param movieName the movie for which we predict the clients' rank
+     * @param userName client name
+     * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+     * the database or the neighbors are not built, returns -1
+     */
+    double predictMovieScoreByUsers(const std::string &movieName, const std::string &userName);
+    /**
+     * gets the movie with the highest prediction by predictMovieScoreByUsers, between the movies
+     * the client did not watch
+     * @param userName clients name
+     * @return the name of the recommended movie, invalid client name message upon failure
+     */
+    std::string recommendByUsers(const std::string &userName);
+    /**
+     * builds the approximate nearest neighbor (hnsw) index of the movie attribute vectors used by
+     * recommendByContentApprox
+     * @param m number of links kept per movie in the graph, at least 2. more links give better
+     * recall for a slower build and search
+     * @param efConstruction number of candidates kept while building
+     * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+     */
+    int buildContentIndex(int m, int efConstruction);
+    /**
+     * sets the number of candidates recommendByContentApprox keeps while searching the index.
+     * a bigger ef gives better recall for more latency.
+     * @param ef at least 1
+     */
+    void setContentIndexEf(int ef);
+    /**
+     * same as recommendByContent, but searches the index built by buildContentIndex instead of
+     * scanning every movie, so it may miss the best movie. falls back to the exact scan while
+     * the index is not built.
+     * @param userName client name
+     * @return movie recommended upon success, invalid client name message upon failure
+     */
+    std::string recommendByContentApprox(const std::string &userName);
+    /**
+     * clusters the movie attribute vectors, so that recommendByContent can skip whole clusters
+     * that provably cannot contain a better movie than the best one found so far. the
+     * recommendations stay identical to the full scan.
+     * @param clusters number of clusters, about the square root of the number of movies works well
+     * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+     */
+    int buildContentClusters(int clusters);
+    /**
+     * computes the random hyperplane lsh signatures of every movie, used as a cheap candidate
+     * filter by recommendByContentLsh and predictMovieScoreForUserLsh
+     * @param tables number of signatures per movie, more tables estimate the angles better
+     * @param bits number of hyperplanes per signature, between 1 and 64
+     * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+     */
+    int buildLsh(int tables, int bits);
+    /**
+     * precomputes for every movie the m movies most similar to it, from the most similar to the
+     * least. predictMovieScoreForUser (and so recommendByCF) then walks the list of the
+     * predicted movie until it finds k movies the client ranked, and falls back to sorting the
+     * client's whole history only when the list holds fewer than k of them.
+     * @param m length of each list
+     * @param quantized if true and buildQuantizedAttributes was called, the lists are picked
+     * with the 8 bit kernels and only the shortlisted pairs are scored in double. this is
+     * faster to build, but a movie near the end of a list may differ from the exact build.
+     * @return 0 upon success, -1 upon invalid m or when no data was loaded
+     */
+    int buildMovieNeighbors(int m, bool quantized = false);
+    /**
+     * computes the cosine similarity of every pair of movies and streams it to a file, tile by
+     * tile, so catalogs whose similarity matrix does not fit in memory can still be precomputed.
+     * see SimilarityTiles::readFile for reading it back.
+     * @param path the file to write
+     * @return 0 upon success, -1 when no data was loaded or the file cannot be written
+     */
+    int writeMovieSimilarities(const std::string &path);
+    /**
+     * builds a sparse graph of the movie similarities, keeping for every movie only the movies
+     * whose similarity with it reaches the threshold, and of those at most the m closest, with
+     * 16 bit float weights. predictMovieScoreForUser (and so recommendByCF) then walks the list
+     * of the predicted movie like the neighbor lists of buildMovieNeighbors, and falls back to
+     * the exact computation when fewer than k ranked movies survived the pruning. its memory
+     * grows with the kept edges, not with the square of the catalog.
+     * @param threshold the lowest similarity kept, -1 keeps every similarity
+     * @param m the most neighbors kept per movie, 0 for no limit
+     * @return 0 upon success, -1 upon invalid parameters or when no data was loaded
+     */
+    int buildSimilarityGraph(double threshold, int m);
+    /**
+     * builds the 8 bit copy of the movie attributes used by recommendByContentQuantized and by
+     * buildMovieNeighbors. it takes a quarter of the memory of the double attributes.
+     * @return 0 upon success, -1 when no data was loaded or an attribute is negative
+     */
+    int buildQuantizedAttributes();
+    /**
+     * same as recommendByContent, but scores the movies with integer dot products on the 8 bit
+     * attributes built by buildQuantizedAttributes, so close scores may be ordered differently.
+     * falls back to the exact scan while the attributes are not built.
+     * @param userName client name
+     * @return movie recommended upon success, invalid client name message upon failure
+     */
+    std::string recommendByContentQuantized(const std::string &userName);
+    /**
+     * builds a flat float copy of the movie attributes and the client ranks, used by
+     * recommendByContentFloat, predictMovieScoreForUserFloat and recommendByCFFloat. the copy
+     * is kept next to the double data, adding about half its size to the memory held; in return
+     * the float scans read half the bytes of the double ones.
+     * @return 0 upon success, -1 when no data was loaded
+     */
+    int buildFloatModel();
+    /**
+     * same as recommendByContent, computed in float on the model built by buildFloatModel, so
+     * close scores may be ordered differently. falls back to recommendByContent while the model
+     * is not built.
+     * @param userName client name
+     * @return movie recommended upon success, invalid client name message upon failure
+     */
+    std::string recommendByContentFloat(const std::string &userName);
+    /**
+     * same as predictMovieScoreForUser, computed in float on the model built by
+     * buildFloatModel. falls back to predictMovieScoreForUser while the model is not built.
+     * @param movieName the movie for which we predict the clients' rank
+     * @param userName client name
+     * @param k
+     * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+     * the database, returns -1
+     */
+    double predictMovieScoreForUserFloat(const std::string &movieName,
+                                         const std::string &userName, int k);
+    /**
+     * same as recommendByCF, computed in float on the model built by buildFloatModel. falls
+     * back to recommendByCF while the model is not built.
+     * @param userName clients name
+     * @param k
+     * @return the name of the movie for which our prediction is the highest
+     */
+    std::string recommendByCFFloat(const std::string &userName, int k);
+    /**
+     * same as recommendByContent, but scores only the unwatched movies whose lsh signatures are
+     * closest to the signature of the client's preference vector
+     * @param userName client name
+     * @param candidates number of movies to score exactly
+     * @return movie recommended upon success, invalid client name message upon failure
+     */
+    std::string recommendByContentLsh(const std::string &userName, int candidates);
+    /**
+     * same as predictMovieScoreForUser, but looks for the k closest movies only between the
+     * ranked movies whose lsh signatures are closest to the signature of the predicted movie
+     * @param movieName the movie for which we predict the clients' rank
+     * @param userName client name
+     * @param k
+     * @param candidates number of ranked movies to score exactly, at least k are scored
+     * @return the prediction of the clients' rank to the movie. if userName/movieName are not in
+     * the database or the signatures are not built, returns -1
+     */
+    double predictMovieScoreForUserLsh(const std::string &movieName, const std::string &userName,
+                                       int k, int candidates);
 };
 
 
@@ -0,0 +1,178 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_SIMILARITY_H
+#define EX5_SIMILARITY_H
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include "VectorMath.h"
+
+/**
+ * the similarity metrics the content and cf algorithms can be instantiated with. every metric
+ * is a policy class with two static functions, so picking a metric costs nothing at runtime:
+ *   stats(a, ctx) - what the metric needs to know about one vector on its own, computed once per
+ *                   vector and query instead of once per pair
+ *   similarity(a, statsA, b, statsB, ctx) - the similarity of two vectors, higher is closer
+ * each metric has its own fused single pass kernel.
+ */
+
+/**
+ * what every metric may need about the whole dataset
+ */
+struct SimilarityContext
+{
+    size_t dims; // length of the compared vectors
+    VectorMath::ExactKernels kernels; // the exact kernels picked for dims
+    const double *attributeMeans; // average of each attribute over all the movies
+};
+
+/**
+ * what a metric knows about a single vector
+ */
+struct VectorStats
+{
+    double mean; // average of the vector's values, when the metric needs it
+    double norm; // the length the metric divides by
+};
+
+/**
+ * the cosine of the angle between the vectors. this is the metric of the original algorithms,
+ * and it keeps their exact kernels so its results do not change by a single bit.
+ */
+struct CosineSimilarity
+{
+    static VectorStats stats(const double *a, const SimilarityContext &ctx)
+    {
+        VectorStats out = {0.0, ctx.kernels.norm(a, ctx.dims)};
+        return out;
+    }
+
+    static double similarity(const double *a, const VectorStats &statsA, const double *b,
+                             const VectorStats &statsB, const SimilarityContext &ctx)
+    {
+        return ctx.kernels.dotProd(a, b, ctx.dims) / (statsA.norm * statsB.norm);
+    }
+};
+
+/**
+ * cosine after subtracting the average of every attribute over the catalog, so attributes
+ * every movie scores high on stop dominating the similarity
+ */
+struct AdjustedCosineSimilarity
+{
+    static VectorStats stats(const double *a, const SimilarityContext &ctx)
+    {
+        VectorStats out = {0.0, std::sqrt(centeredDotProd(a, a, ctx))};
+        return out;
+    }
+
+    static double similarity(const double *a, const VectorStats &statsA, const double *b,
+                             const VectorStats &statsB, const SimilarityContext &ctx)
+    {
+        return centeredDotProd(a, b, ctx) / (statsA.norm * statsB.norm);
+    }
+
+    /**
+     * @return sum over j of (a[j] - mean[j]) * (b[j] - mean[j]), in a single pass
+     */
+    static double centeredDotProd(const double *a, const double *b, const SimilarityContext &ctx)
+    {
+        const double *mean = ctx.attributeMeans;
+        double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+        size_t j = 0;
+        for (; j + 4 <= ctx.dims; j += 4)
+        {
+            acc0 += (a[j] - mean[j]) * (b[j] - mean[j]);
+            acc1 += (a[j + 1] - mean[j + 1]) * (b[j + 1] - mean[j + 1]);
+            acc2 += (a[j + 2] - mean[j + 2]) * (b[j + 2] - mean[j + 2]);
+            acc3 += (a[j + 3] - mean[j + 3]) * (b[j + 3] - mean[j + 3]);
+        }
+        for (; j < ctx.dims; j++)
+        {
+            acc0 += (a[j] - mean[j]) * (b[j] - mean[j]);
+        }
+        return (acc0 + acc1) + (acc2 + acc3);
+    }
+};
+
+/**
+ * pearson correlation: cosine after subtracting each vector's own average, so only the shape
+ * of the attribute profile matters and not its overall level
+ */
+struct PearsonSimilarity
+{
+    static VectorStats stats(const double *a, const SimilarityContext &ctx)
+    {
+        double sum = 0.0;
+        for (size_t j = 0; j < ctx.dims; j++)
+        {
+            sum += a[j];
+        }
+        double mean = sum / ctx.dims;
+        double squares = VectorMath::dotProd(a, a, ctx.dims) - ctx.dims * mean * mean;
+        VectorStats out = {mean, std::sqrt(std::max(squares, 0.0))};
+        return out;
+    }
+
+    static double similarity(const double *a, const VectorStats &statsA, const double *b,
+                             const VectorStats &statsB, const SimilarityContext &ctx)
+    { // sum of (a - meanA) * (b - meanB) expands to the plain dot product minus n * meanA * meanB
+        return (VectorMath::dotProd(a, b, ctx.dims) - ctx.dims * statsA.mean * statsB.mean) /
+               (statsA.norm * statsB.norm);
+    }
+};
+
+/**
+ * the plain dot product, which also rewards vectors for being long
+ */
+struct DotProductSimilarity
+{
+    static VectorStats stats(const double *, const SimilarityContext &)
+    {
+        VectorStats out = {0.0, 1.0};
+        return out;
+    }
+
+    static double similarity(const double *a, const VectorStats &, const double *b,
+                             const VectorStats &, const SimilarityContext &ctx)
+    {
+        return VectorMath::dotProd(a, b, ctx.dims);
+    }
+};
+
+/**
+ * 1 / (1 + euclidean distance), in (0, 1], 1 for identical vectors
+ */
+struct EuclideanSimilarity
+{
+    static VectorStats stats(const double *, const SimilarityContext &)
+    {
+        VectorStats out = {0.0, 0.0};
+        return out;
+    }
+
+    static double similarity(const double *a, const VectorStats &, const double *b,
+                             const VectorStats &, const SimilarityContext &ctx)
+    {
+        double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+        size_t j = 0;
+        for (; j + 4 <= ctx.dims; j += 4)
+        {
+            acc0 += (a[j] - b[j]) * (a[j] - b[j]);
+            acc1 += (a[j + 1] - b[j + 1]) * (a[j + 1] - b[j + 1]);
+            acc2 += (a[j + 2] - b[j + 2]) * (a[j + 2] - b[j + 2]);
+            acc3 += (a[j + 3] - b[j + 3]) * (a[j + 3] - b[j + 3]);
+        }
+        for (; j < ctx.dims; j++)
+        {
+            acc0 += (a[j] - b[j]) * (a[j] - b[j]);
+        }
+        return 1.0 / (1.0 + std::sqrt((acc0 + acc1) + (acc2 + acc3)));
+    }
+};
+
+
+#endif //EX5_SIMILARITY_H
@@ -0,0 +1,240 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "SimilarityGraph.h"
+#include "SimilarityTiles.h"
+#include <algorithm>
+#include <mutex>
+#include <cstring>
+#include <cmath>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define GRAPH_TILE 64 // a multiple of the tile builder's micro kernel, so it is used as is
+
+
+/**
+ * builds the graph with the tiled all pairs builder
+ * @param vectors the attribute vectors, all of the same length, index i is movie i
+ * @param threshold the lowest similarity kept
+ * @param m the most neighbors kept per movie, 0 for no limit
+ * @param pool the workers to build with
+ * @return 0 upon success, -1 upon invalid parameters
+ */
+int SimilarityGraph::build(const std::vector<const std::vector<double> *> &vectors,
+                           double threshold, int m, ThreadPool &pool)
+{
+    if (m < 0 || vectors.empty() || std::isnan(threshold))
+    {
+        return BUILD_FAIL;
+    }
+    size_t moviesNum = vectors.size();
+    auto closerFirst = [](const std::pair<double, unsigned int> &lhs,
+                          const std::pair<double, unsigned int> &rhs)
+    {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    };
+    // the kept candidates of each movie. with a limit they form a heap whose front is the
+    // farthest, so a closer candidate replaces it
+    std::vector<std::vector<std::pair<double, unsigned int> > > kept(moviesNum);
+    auto offer = [&kept, &closerFirst, m](size_t movie, double sim, size_t other)
+    {
+        std::vector<std::pair<double, unsigned int> > &heap = kept[movie];
+        heap.emplace_back(sim, (unsigned int) other);
+        if (m != 0)
+        {
+            std::push_heap(heap.begin(), heap.end(), closerFirst);
+            if (heap.size() > (size_t) m)
+            {
+                std::pop_heap(heap.begin(), heap.end(), closerFirst);
+                heap.pop_back();
+            }
+        }
+    };
+    // a tile touches the movies of its row block, and through its mirror image those of its
+    // column block, so each block of movies has its own lock
+    std::vector<std::mutex> locks((moviesNum + GRAPH_TILE - 1) / GRAPH_TILE);
+    SimilarityTiles(GRAPH_TILE).forEachTile(vectors, pool, [&](const SimilarityTile &tile,
+                                                                unsigned int)
+    {
+        {
+            std::lock_guard<std::mutex> guard(locks[tile.rowBegin / GRAPH_TILE]);
+            for (size_t r = 0; r < tile.rows; r++)
+            {
+                for (size_t c = 0; c < tile.cols; c++)
+                {
+                    if (tile.at(r, c) >= threshold)
+                    {
+                        offer(tile.rowBegin + r, tile.at(r, c), tile.colBegin + c);
+                    }
+                }
+            }
+        }
+        if (tile.colBegin != tile.rowBegin)
+        {
+            std::lock_guard<std::mutex> guard(locks[tile.colBegin / GRAPH_TILE]);
+            for (size_t c = 0; c < tile.cols; c++)
+            {
+                for (size_t r = 0; r < tile.rows; r++)
+                {
+                    if (tile.at(r, c) >= threshold)
+                    {
+                        offer(tile.colBegin + c, tile.at(r, c), tile.rowBegin + r);
+                    }
+                }
+            }
+        }
+    });
+    _offsets.assign(moviesNum + 1, 0);
+    for (size_t i = 0; i < moviesNum; i++)
+    {
+        _offsets[i + 1] = _offsets[i] + kept[i].size();
+    }
+    _neighbors.resize(_offsets[moviesNum]);
+    _sims.resize(_offsets[moviesNum]);
+    for (size_t i = 0; i < moviesNum; i++)
+    {
+        std::sort(kept[i].begin(), kept[i].end(), closerFirst);
+        for (size_t p = 0; p < kept[i].size(); p++)
+        {
+            _neighbors[_offsets[i] + p] = kept[i][p].second;
+            _sims[_offsets[i] + p] = toHalf((float) kept[i][p].first);
+        }
+        std::vector<std::pair<double, unsigned int> >().swap(kept[i]);
+    }
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool SimilarityGraph::isBuilt() const
+{
+    return !_offsets.empty();
+}
+
+/**
+ * @return the bytes held by the graph
+ */
+size_t SimilarityGraph::bytes() const
+{
+    return _offsets.size() * sizeof(size_t) + _neighbors.size() * sizeof(unsigned int) +
+           _sims.size() * sizeof(uint16_t);
+}
+
+/**
+ * @return the number of kept edges
+ */
+size_t SimilarityGraph::edges() const
+{
+    return _neighbors.size();
+}
+
+/**
+ * the similarity weighted average of the client's ranks of the k most similar movies they
+ * ranked
+ * @param movie the predicted movie
+ * @param userRanks the client's rank vector, 0.0 means not ranked
+ * @param k
+ * @param prediction output, the prediction if found
+ * @return true if the list of the movie holds at least k movies the client ranked
+ */
+bool SimilarityGraph::predict(size_t movie, const std::vector<double> &userRanks, int k,
+                              double &prediction) const
+{
+    double numerator = 0.0;
+    double denominator = 0.0;
+    int found = 0;
+    for (size_t p = _offsets[movie]; p < _offsets[movie + 1] && found < k; p++)
+    {
+        double rank = userRanks[_neighbors[p]];
+        if (rank != 0.0)
+        {
+            double sim = fromHalf(_sims[p]);
+            numerator += sim * rank;
+            denominator += sim;
+            found++;
+        }
+    }
+    prediction = numerator / denominator;
+    return found == k;
+}
+
+/**
+ * @param value
+ * @return the nearest half precision float, ties to even
+ */
+uint16_t SimilarityGraph::toHalf(float value)
+{
+#if defined(__F16C__)
+    return (uint16_t) _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT);
+#else
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t magnitude = bits & 0x7fffffff;
+    if (magnitude >= 0x7f800000)
+    { // infinity, or nan kept quiet
+        return (uint16_t) (sign | 0x7c00 | ((magnitude > 0x7f800000) ? 0x200 : 0));
+    }
+    if (magnitude >= 0x477ff000)
+    { // rounds past the largest half, 65504
+        return (uint16_t) (sign | 0x7c00);
+    }
+    if (magnitude <= 0x33000000)
+    { // at most half of the smallest subnormal half, 2^-24
+        return (uint16_t) sign;
+    }
+    uint32_t half;
+    uint32_t rest;
+    uint32_t halfway;
+    if (magnitude < 0x38800000)
+    { // below the smallest normal half, 2^-14: a subnormal in units of 2^-24
+        uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+        uint32_t shift = 126 - (magnitude >> 23);
+        half = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else
+    { // rebias the exponent from 127 to 15 and drop 13 mantissa bits
+        half = (magnitude - 0x38000000) >> 13;
+        rest = magnitude & 0x1fff;
+        halfway = 0x1000;
+    }
+    if (rest > halfway || (rest == halfway && (half & 1)))
+    { // a carry out of the mantissa correctly moves to the next exponent
+        half++;
+    }
+    return (uint16_t) (sign | half);
+#endif
+}
+
+/**
+ * @param half a half precision float
+ * @return its value
+ */
+float SimilarityGraph::fromHalf(uint16_t half)
+{
+#if defined(__F16C__)
+    return _cvtsh_ss(half);
+#else
+    uint32_t sign = (uint32_t) (half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    if (exponent == 0)
+    { // zero or subnormal, mantissa * 2^-24
+        float value = std::ldexp((float) mantissa, -24);
+        return sign ? -value : value;
+    }
+    uint32_t bits = (exponent == 0x1f) ? (sign | 0x7f800000 | (mantissa << 13))
+                                       : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+#endif
+}
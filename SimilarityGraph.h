@@ -0,0 +1,72 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_SIMILARITYGRAPH_H
+#define EX5_SIMILARITYGRAPH_H
+
+#include <vector>
+#include <cstdint>
+#include "ThreadPool.h"
+
+/**
+ * a sparse movie to movie similarity graph: for every movie, only the movies whose cosine with
+ * it reaches a threshold, and of those at most the m most similar (itself included), from the
+ * most similar to the least. the lists are stored in csr form with 16 bit float similarities, so
+ * the graph grows with the number of kept edges instead of the square of the catalog. the
+ * lists are picked and ordered by the exact cosines; only the stored weights are rounded.
+ */
+class SimilarityGraph
+{
+private:
+    std::vector<size_t> _offsets; // range of each movie in _neighbors and _sims
+    std::vector<unsigned int> _neighbors;
+    std::vector<uint16_t> _sims; // the similarities, as ieee 754 half precision floats
+public:
+    /**
+     * builds the graph with the tiled all pairs builder
+     * @param vectors the attribute vectors, all of the same length, index i is movie i
+     * @param threshold the lowest similarity kept
+     * @param m the most neighbors kept per movie, 0 for no limit
+     * @param pool the workers to build with
+     * @return 0 upon success, -1 upon invalid parameters
+     */
+    int build(const std::vector<const std::vector<double> *> &vectors, double threshold, int m,
+              ThreadPool &pool);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * @return the bytes held by the graph
+     */
+    size_t bytes() const;
+    /**
+     * @return the number of kept edges
+     */
+    size_t edges() const;
+    /**
+     * the similarity weighted average of the client's ranks of the k most similar movies they
+     * ranked
+     * @param movie the predicted movie
+     * @param userRanks the client's rank vector, 0.0 means not ranked
+     * @param k
+     * @param prediction output, the prediction if found
+     * @return true if the list of the movie holds at least k movies the client ranked
+     */
+    bool predict(size_t movie, const std::vector<double> &userRanks, int k,
+                 double &prediction) const;
+    /**
+     * @param value
+     * @return the nearest half precision float, ties to even
+     */
+    static uint16_t toHalf(float value);
+    /**
+     * @param half a half precision float
+     * @return its value
+     */
+    static float fromHalf(uint16_t half);
+};
+
+
+#endif //EX5_SIMILARITYGRAPH_H
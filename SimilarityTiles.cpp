@@ -0,0 +1,236 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "SimilarityTiles.h"
+#include "VectorMath.h"
+#include <fstream>
+#include <mutex>
+#include <cstring>
+#include <cstdint>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+#define KERNEL_ROWS 4 // rows of the block the micro kernel keeps in registers
+#define KERNEL_COLS 8 // columns of that block, a whole avx512 register or two avx2 ones
+#define FILE_MAGIC "SIMTILE1"
+#define MAGIC_BYTES 8
+
+
+/**
+ * the dot products of KERNEL_ROWS packed rows and KERNEL_COLS packed columns. each product is
+ * summed in attribute order, like VectorMath::exactDotProd, while the KERNEL_COLS products of a
+ * row are independent lanes of the same multiply-add.
+ * @param rows KERNEL_ROWS rows, one after the other
+ * @param cols the transposed columns, attribute j of column c at j * colStride + c
+ * @param colStride
+ * @param dims number of attributes
+ * @param out the block of the tile to write, row r column c at r * outStride + c
+ * @param outStride
+ */
+static void microKernel(const double *rows, const double *cols, size_t colStride, size_t dims,
+                        double *out, size_t outStride)
+{
+    double acc[KERNEL_ROWS][KERNEL_COLS] = {};
+    for (size_t j = 0; j < dims; j++)
+    {
+        const double *col = cols + j * colStride;
+        for (size_t r = 0; r < KERNEL_ROWS; r++)
+        {
+            double a = rows[r * dims + j];
+            for (size_t c = 0; c < KERNEL_COLS; c++)
+            {
+                acc[r][c] += a * col[c];
+            }
+        }
+    }
+    for (size_t r = 0; r < KERNEL_ROWS; r++)
+    {
+        std::memcpy(out + r * outStride, acc[r], sizeof(acc[r]));
+    }
+}
+
+/**
+ * @param tile rows and columns of a tile, rounded up to a multiple of the micro kernel
+ */
+SimilarityTiles::SimilarityTiles(size_t tile)
+{
+    size_t unit = KERNEL_COLS; // a multiple of KERNEL_ROWS as well
+    _tile = (tile == 0) ? unit : (tile + unit - 1) / unit * unit;
+}
+
+/**
+ * computes the tiles on and above the diagonal. the tiles on the diagonal are whole squares,
+ * the ones above it stand for their mirror image below it as well.
+ * @param vectors the attribute vectors, all of the same length, index i is movie i
+ * @param pool the workers to compute with
+ * @param sink gets every tile, concurrently from the workers
+ * @return 0 upon success, -1 when there are no movies
+ */
+int SimilarityTiles::forEachTile(const std::vector<const std::vector<double> *> &vectors,
+                                 ThreadPool &pool, const TileSink &sink) const
+{
+    if (vectors.empty())
+    {
+        return BUILD_FAIL;
+    }
+    size_t moviesNum = vectors.size();
+    size_t dims = vectors[0]->size();
+    VectorMath::ExactKernels kernels = VectorMath::exactKernelsFor(dims);
+    std::vector<double> norms(moviesNum);
+    for (size_t i = 0; i < moviesNum; i++)
+    {
+        norms[i] = kernels.norm(vectors[i]->data(), dims);
+    }
+    size_t blocks = (moviesNum + _tile - 1) / _tile;
+    std::vector<std::pair<size_t, size_t> > tiles; // the upper triangle, row block first
+    for (size_t rowBlock = 0; rowBlock < blocks; rowBlock++)
+    {
+        for (size_t colBlock = rowBlock; colBlock < blocks; colBlock++)
+        {
+            tiles.emplace_back(rowBlock, colBlock);
+        }
+    }
+    // per worker buffers: the packed rows, the packed transposed columns and the tile
+    std::vector<std::vector<double> > packedRows(pool.size(), std::vector<double>(_tile * dims));
+    std::vector<std::vector<double> > packedCols(pool.size(), std::vector<double>(dims * _tile));
+    std::vector<std::vector<double> > values(pool.size(), std::vector<double>(_tile * _tile));
+    pool.parallelFor(0, tiles.size(), [&](size_t t, unsigned int worker)
+    {
+        SimilarityTile tile = {tiles[t].first * _tile, 0, tiles[t].second * _tile, 0, nullptr};
+        tile.rows = std::min(_tile, moviesNum - tile.rowBegin);
+        tile.cols = std::min(_tile, moviesNum - tile.colBegin);
+        double *rows = packedRows[worker].data();
+        double *cols = packedCols[worker].data();
+        double *out = values[worker].data();
+        // rows and columns past the last movie are zero, and their results are never read
+        std::fill(packedRows[worker].begin(), packedRows[worker].end(), 0.0);
+        std::fill(packedCols[worker].begin(), packedCols[worker].end(), 0.0);
+        for (size_t r = 0; r < tile.rows; r++)
+        {
+            std::memcpy(rows + r * dims, vectors[tile.rowBegin + r]->data(), dims * sizeof(double));
+        }
+        for (size_t c = 0; c < tile.cols; c++)
+        {
+            const double *vec = vectors[tile.colBegin + c]->data();
+            for (size_t j = 0; j < dims; j++)
+            {
+                cols[j * _tile + c] = vec[j];
+            }
+        }
+        for (size_t r = 0; r < tile.rows; r += KERNEL_ROWS)
+        {
+            for (size_t c = 0; c < tile.cols; c += KERNEL_COLS)
+            {
+                microKernel(rows + r * dims, cols + c, _tile, dims, out + r * _tile + c, _tile);
+            }
+        }
+        for (size_t r = 0; r < tile.rows; r++)
+        { // the same division as the neighbor lists and _findMovieByHistory
+            for (size_t c = 0; c < tile.cols; c++)
+            {
+                out[r * tile.cols + c] = out[r * _tile + c] /
+                                         (norms[tile.colBegin + c] * norms[tile.rowBegin + r]);
+            }
+        }
+        tile.values = out;
+        sink(tile, worker);
+    });
+    return BUILD_SUCCESS;
+}
+
+/**
+ * computes the whole matrix
+ * @param vectors the attribute vectors, all of the same length, index i is movie i
+ * @param pool the workers to compute with
+ * @param matrix output, movies x movies, row major
+ * @return 0 upon success, -1 when there are no movies
+ */
+int SimilarityTiles::toMatrix(const std::vector<const std::vector<double> *> &vectors,
+                              ThreadPool &pool, std::vector<double> &matrix) const
+{
+    size_t moviesNum = vectors.size();
+    matrix.assign(moviesNum * moviesNum, 0.0);
+    return forEachTile(vectors, pool, [&matrix, moviesNum](const SimilarityTile &tile,
+                                                           unsigned int)
+    { // the tiles cover disjoint cells, and so do their mirror images
+        for (size_t r = 0; r < tile.rows; r++)
+        {
+            for (size_t c = 0; c < tile.cols; c++)
+            {
+                size_t row = tile.rowBegin + r;
+                size_t col = tile.colBegin + c;
+                matrix[row * moviesNum + col] = tile.at(r, c);
+                matrix[col * moviesNum + row] = tile.at(r, c);
+            }
+        }
+    });
+}
+
+/**
+ * computes the tiles and streams them to a file, holding only the tiles being computed
+ * @param vectors the attribute vectors, all of the same length, index i is movie i
+ * @param pool the workers to compute with
+ * @param path the file to write, see readFile
+ * @return 0 upon success, -1 when there are no movies or the file cannot be written
+ */
+int SimilarityTiles::toFile(const std::vector<const std::vector<double> *> &vectors,
+                            ThreadPool &pool, const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return BUILD_FAIL;
+    }
+    uint64_t moviesNum = vectors.size();
+    file.write(FILE_MAGIC, MAGIC_BYTES);
+    file.write((const char *) &moviesNum, sizeof(moviesNum));
+    std::mutex lock;
+    int result = forEachTile(vectors, pool, [&file, &lock](const SimilarityTile &tile,
+                                                           unsigned int)
+    { // a record is the tile's position and shape followed by its values
+        uint64_t header[] = {tile.rowBegin, tile.rows, tile.colBegin, tile.cols};
+        std::lock_guard<std::mutex> guard(lock);
+        file.write((const char *) header, sizeof(header));
+        file.write((const char *) tile.values, tile.rows * tile.cols * sizeof(double));
+    });
+    file.flush();
+    return (result == BUILD_SUCCESS && file) ? BUILD_SUCCESS : BUILD_FAIL;
+}
+
+/**
+ * reads back a file written by toFile, one tile at a time
+ * @param path
+ * @param sink gets every tile, with worker 0
+ * @param movies output, the number of movies of the matrix
+ * @return 0 upon success, -1 when the file cannot be read or is not a tiles file
+ */
+int SimilarityTiles::readFile(const std::string &path, const TileSink &sink, size_t &movies)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[MAGIC_BYTES];
+    uint64_t moviesNum;
+    if (!file.read(magic, MAGIC_BYTES) || std::memcmp(magic, FILE_MAGIC, MAGIC_BYTES) != 0 ||
+        !file.read((char *) &moviesNum, sizeof(moviesNum)))
+    {
+        return BUILD_FAIL;
+    }
+    movies = moviesNum;
+    uint64_t header[4];
+    std::vector<double> values;
+    while (file.read((char *) header, sizeof(header)))
+    {
+        if (header[0] + header[1] > moviesNum || header[2] + header[3] > moviesNum)
+        {
+            return BUILD_FAIL;
+        }
+        values.resize(header[1] * header[3]);
+        if (!file.read((char *) values.data(), values.size() * sizeof(double)))
+        {
+            return BUILD_FAIL;
+        }
+        SimilarityTile tile = {header[0], header[1], header[2], header[3], values.data()};
+        sink(tile, 0);
+    }
+    return BUILD_SUCCESS;
+}
@@ -0,0 +1,97 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_SIMILARITYTILES_H
+#define EX5_SIMILARITYTILES_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include "ThreadPool.h"
+
+/**
+ * a block of the movie to movie similarity matrix: the cosines of rows
+ * [rowBegin, rowBegin + rows) against columns [colBegin, colBegin + cols)
+ */
+struct SimilarityTile
+{
+    size_t rowBegin;
+    size_t rows;
+    size_t colBegin;
+    size_t cols;
+    const double *values; // rows x cols, row major
+
+    /**
+     * @param row index inside the tile
+     * @param col index inside the tile
+     * @return the cosine of movie rowBegin + row and movie colBegin + col
+     */
+    double at(size_t row, size_t col) const
+    {
+        return values[row * cols + col];
+    }
+};
+
+/**
+ * computes all the movie to movie cosine similarities. the matrix is symmetric, so only the
+ * tiles on and above the diagonal are computed, each once, and the workers take them in parallel.
+ * a tile packs its rows and the transpose of its columns into small buffers, and a micro kernel
+ * keeps a block of 4 x 8 dot products in registers, adding one attribute of all of them per step.
+ * every dot product is still summed in attribute order, so the cosines equal the recommender's
+ * own scores bit for bit. the tiles go to a callback, into a dense matrix, or to a file for
+ * catalogs whose matrix does not fit in memory.
+ */
+class SimilarityTiles
+{
+private:
+    size_t _tile; // rows and columns of a tile
+public:
+    /**
+     * the callback receiving the tiles. it is called from the workers, concurrently
+     */
+    typedef std::function<void(const SimilarityTile &tile, unsigned int worker)> TileSink;
+    /**
+     * @param tile rows and columns of a tile, rounded up to a multiple of the micro kernel
+     */
+    explicit SimilarityTiles(size_t tile = 64);
+    /**
+     * computes the tiles on and above the diagonal. the tiles on the diagonal are whole squares,
+     * the ones above it stand for their mirror image below it as well.
+     * @param vectors the attribute vectors, all of the same length, index i is movie i
+     * @param pool the workers to compute with
+     * @param sink gets every tile, concurrently from the workers
+     * @return 0 upon success, -1 when there are no movies
+     */
+    int forEachTile(const std::vector<const std::vector<double> *> &vectors, ThreadPool &pool,
+                    const TileSink &sink) const;
+    /**
+     * computes the whole matrix
+     * @param vectors the attribute vectors, all of the same length, index i is movie i
+     * @param pool the workers to compute with
+     * @param matrix output, movies x movies, row major
+     * @return 0 upon success, -1 when there are no movies
+     */
+    int toMatrix(const std::vector<const std::vector<double> *> &vectors, ThreadPool &pool,
+                 std::vector<double> &matrix) const;
+    /**
+     * computes the tiles and streams them to a file, holding only the tiles being computed
+     * @param vectors the attribute vectors, all of the same length, index i is movie i
+     * @param pool the workers to compute with
+     * @param path the file to write, see readFile
+     * @return 0 upon success, -1 when there are no movies or the file cannot be written
+     */
+    int toFile(const std::vector<const std::vector<double> *> &vectors, ThreadPool &pool,
+               const std::string &path) const;
+    /**
+     * reads back a file written by toFile, one tile at a time
+     * @param path
+     * @param sink gets every tile, with worker 0
+     * @param movies output, the number of movies of the matrix
+     * @return 0 upon success, -1 when the file cannot be read or is not a tiles file
+     */
+    static int readFile(const std::string &path, const TileSink &sink, size_t &movies);
+};
+
+
+#endif //EX5_SIMILARITYTILES_H
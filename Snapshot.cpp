@@ -0,0 +1,189 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "Snapshot.h"
+#include <cstring>
+
+#define SNAPSHOT_SUCCESS 0
+#define SNAPSHOT_FAIL -1
+#define CLIENT_READ 1
+#define SNAPSHOT_END 0
+#define SNAPSHOT_MAGIC "RECSNAP1"
+#define MAGIC_BYTES 8
+#define MAX_NAME 4096 // longer names mean a corrupt snapshot
+
+
+/**
+ * writes a length prefixed string
+ * @param str
+ */
+void SnapshotWriter::_writeString(const std::string &str)
+{
+    uint32_t length = (uint32_t) str.size();
+    _file.write((const char *) &length, sizeof(length));
+    _file.write(str.data(), length);
+}
+
+/**
+ * opens the snapshot and writes the movies
+ * @param path
+ * @param movieNames in the order of the rank vectors
+ * @param attributes the attribute vector of every movie, all of the same length
+ * @return 0 upon success, -1 when the file cannot be written or the movies are invalid
+ */
+int SnapshotWriter::open(const std::string &path, const std::vector<std::string> &movieNames,
+                         const std::vector<const std::vector<double> *> &attributes)
+{
+    if (movieNames.size() != attributes.size() || attributes.empty())
+    {
+        return SNAPSHOT_FAIL;
+    }
+    _file.open(path, std::ios::binary | std::ios::trunc);
+    if (!_file)
+    {
+        return SNAPSHOT_FAIL;
+    }
+    _moviesNum = movieNames.size();
+    uint64_t header[] = {_moviesNum, attributes[0]->size()};
+    _file.write(SNAPSHOT_MAGIC, MAGIC_BYTES);
+    _file.write((const char *) header, sizeof(header));
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        if (attributes[i]->size() != header[1])
+        {
+            return SNAPSHOT_FAIL;
+        }
+        _writeString(movieNames[i]);
+        _file.write((const char *) attributes[i]->data(), header[1] * sizeof(double));
+    }
+    return _file ? SNAPSHOT_SUCCESS : SNAPSHOT_FAIL;
+}
+
+/**
+ * appends a client
+ * @param name
+ * @param ranks the client's rank of every movie, 0.0 means not ranked
+ * @return 0 upon success, -1 upon a write error
+ */
+int SnapshotWriter::addClient(const std::string &name, const std::vector<double> &ranks)
+{
+    _writeString(name);
+    uint32_t count = 0;
+    for (size_t i = 0; i < ranks.size() && i < _moviesNum; i++)
+    {
+        count += (ranks[i] != 0.0);
+    }
+    _file.write((const char *) &count, sizeof(count));
+    for (size_t i = 0; i < ranks.size() && i < _moviesNum; i++)
+    {
+        if (ranks[i] != 0.0)
+        {
+            uint32_t movie = (uint32_t) i;
+            _file.write((const char *) &movie, sizeof(movie));
+            _file.write((const char *) &ranks[i], sizeof(double));
+        }
+    }
+    return _file ? SNAPSHOT_SUCCESS : SNAPSHOT_FAIL;
+}
+
+/**
+ * flushes and closes the snapshot
+ * @return 0 upon success, -1 upon a write error
+ */
+int SnapshotWriter::close()
+{
+    _file.close();
+    return _file ? SNAPSHOT_SUCCESS : SNAPSHOT_FAIL;
+}
+
+/**
+ * reads a length prefixed string
+ * @param str output
+ * @return true upon success
+ */
+bool SnapshotReader::_readString(std::string &str)
+{
+    uint32_t length;
+    if (!_file.read((char *) &length, sizeof(length)) || length > MAX_NAME)
+    {
+        return false;
+    }
+    str.resize(length);
+    return (bool) _file.read(&str[0], length);
+}
+
+/**
+ * opens the snapshot and reads the movies
+ * @param path
+ * @param movieNames output, in the order of the rank vectors
+ * @param attributes output, the attribute vector of every movie
+ * @return 0 upon success, -1 when the file cannot be read or is not a snapshot
+ */
+int SnapshotReader::open(const std::string &path, std::vector<std::string> &movieNames,
+                         std::vector<std::vector<double> > &attributes)
+{
+    _file.open(path, std::ios::binary);
+    char magic[MAGIC_BYTES];
+    uint64_t header[2];
+    if (!_file.read(magic, MAGIC_BYTES) || std::memcmp(magic, SNAPSHOT_MAGIC, MAGIC_BYTES) != 0 ||
+        !_file.read((char *) header, sizeof(header)))
+    {
+        return SNAPSHOT_FAIL;
+    }
+    // every movie takes at least its name length and its attributes, so a header that asks for
+    // more than the rest of the file holds is corrupt, and must not size the outputs
+    std::streampos movies = _file.tellg();
+    _file.seekg(0, std::ios::end);
+    uint64_t left = (uint64_t) (_file.tellg() - movies);
+    _file.seekg(movies);
+    if (!_file || header[1] > left / sizeof(double) ||
+        header[0] > left / (sizeof(uint32_t) + header[1] * sizeof(double)))
+    {
+        return SNAPSHOT_FAIL;
+    }
+    _moviesNum = header[0];
+    movieNames.assign(_moviesNum, std::string());
+    attributes.assign(_moviesNum, std::vector<double>(header[1]));
+    for (size_t i = 0; i < _moviesNum; i++)
+    {
+        if (!_readString(movieNames[i]) ||
+            !_file.read((char *) attributes[i].data(), header[1] * sizeof(double)))
+        {
+            return SNAPSHOT_FAIL;
+        }
+    }
+    return SNAPSHOT_SUCCESS;
+}
+
+/**
+ * reads the next client
+ * @param name output
+ * @param ranks output, the client's rank of every movie, 0.0 means not ranked
+ * @return 1 if a client was read, 0 at the end of the snapshot, -1 upon a corrupt client
+ */
+int SnapshotReader::nextClient(std::string &name, std::vector<double> &ranks)
+{
+    if (_file.peek() == std::ifstream::traits_type::eof())
+    {
+        return SNAPSHOT_END;
+    }
+    uint32_t count;
+    if (!_readString(name) || !_file.read((char *) &count, sizeof(count)) || count > _moviesNum)
+    {
+        return SNAPSHOT_FAIL;
+    }
+    ranks.assign(_moviesNum, 0.0);
+    for (uint32_t p = 0; p < count; p++)
+    {
+        uint32_t movie;
+        double rank;
+        if (!_file.read((char *) &movie, sizeof(movie)) ||
+            !_file.read((char *) &rank, sizeof(rank)) || movie >= _moviesNum)
+        {
+            return SNAPSHOT_FAIL;
+        }
+        ranks[movie] = rank;
+    }
+    return CLIENT_READ;
+}
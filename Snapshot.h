@@ -0,0 +1,93 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_SNAPSHOT_H
+#define EX5_SNAPSHOT_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+/**
+ * a binary snapshot of the recommender's input: the movies with their attributes, then the
+ * clients with their ranks, kept sparse. it is written and read one client at a time, so a
+ * snapshot can be streamed out by a generator without holding every client in memory, and it
+ * loads without parsing text.
+ *
+ * layout, in the host's byte order:
+ *   "RECSNAP1", uint64 movies, uint64 attributes
+ *   per movie: uint32 name length, the name, the attributes as doubles
+ *   per client, until the end of the file: uint32 name length, the name, uint32 ranked count,
+ *   and per ranked movie: uint32 movie index, double rank
+ */
+class SnapshotWriter
+{
+private:
+    std::ofstream _file;
+    size_t _moviesNum = 0;
+    /**
+     * writes a length prefixed string
+     * @param str
+     */
+    void _writeString(const std::string &str);
+public:
+    /**
+     * opens the snapshot and writes the movies
+     * @param path
+     * @param movieNames in the order of the rank vectors
+     * @param attributes the attribute vector of every movie, all of the same length
+     * @return 0 upon success, -1 when the file cannot be written or the movies are invalid
+     */
+    int open(const std::string &path, const std::vector<std::string> &movieNames,
+             const std::vector<const std::vector<double> *> &attributes);
+    /**
+     * appends a client
+     * @param name
+     * @param ranks the client's rank of every movie, 0.0 means not ranked
+     * @return 0 upon success, -1 upon a write error
+     */
+    int addClient(const std::string &name, const std::vector<double> &ranks);
+    /**
+     * flushes and closes the snapshot
+     * @return 0 upon success, -1 upon a write error
+     */
+    int close();
+};
+
+/**
+ * reads a snapshot written by SnapshotWriter
+ */
+class SnapshotReader
+{
+private:
+    std::ifstream _file;
+    size_t _moviesNum = 0;
+    /**
+     * reads a length prefixed string
+     * @param str output
+     * @return true upon success
+     */
+    bool _readString(std::string &str);
+public:
+    /**
+     * opens the snapshot and reads the movies
+     * @param path
+     * @param movieNames output, in the order of the rank vectors
+     * @param attributes output, the attribute vector of every movie
+     * @return 0 upon success, -1 when the file cannot be read or is not a snapshot
+     */
+    int open(const std::string &path, std::vector<std::string> &movieNames,
+             std::vector<std::vector<double> > &attributes);
+    /**
+     * reads the next client
+     * @param name output
+     * @param ranks output, the client's rank of every movie, 0.0 means not ranked
+     * @return 1 if a client was read, 0 at the end of the snapshot, -1 upon a corrupt client
+     */
+    int nextClient(std::string &name, std::vector<double> &ranks);
+};
+
+
+#endif //EX5_SNAPSHOT_H
@@ -0,0 +1,150 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <atomic>
+#include <algorithm>
+
+#define CHUNKS_PER_WORKER 8
+
+
+/**
+ * starts the workers
+ * @param threads number of workers, 0 means one worker per hardware thread
+ */
+ThreadPool::ThreadPool(unsigned int threads)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        _workers.emplace_back(&ThreadPool::_workerLoop, this);
+    }
+}
+
+/**
+ * waits for the queued tasks and joins the workers
+ */
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stop = true;
+    }
+    _hasTask.notify_all();
+    for (std::thread &worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * @return the number of workers in the pool
+ */
+unsigned int ThreadPool::size() const
+{
+    return (unsigned int) _workers.size();
+}
+
+/**
+ * the loop each worker runs: pops tasks from the queue until the pool is stopped
+ */
+void ThreadPool::_workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            _hasTask.wait(guard, [this] { return _stop || !_tasks.empty(); });
+            if (_tasks.empty())
+            { // stopped and nothing left to do
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+        {
+            RECOMMENDER_TRACE_SPAN("task", "pool");
+            task();
+        }
+        std::lock_guard<std::mutex> guard(_lock);
+        if (--_pending == 0)
+        {
+            _allDone.notify_all();
+        }
+    }
+}
+
+/**
+ * queues a task to be run by one of the workers
+ * @param task
+ */
+void ThreadPool::submit(const std::function<void()> &task)
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _tasks.push(task);
+        _pending++;
+    }
+    _hasTask.notify_one();
+}
+
+/**
+ * blocks until every submitted task has finished
+ */
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+    _allDone.wait(guard, [this] { return _pending == 0; });
+}
+
+/**
+ * runs task(i) for every i in [begin, end), splitting the range into chunks between the
+ * workers, and returns once all of them are done. must not be called from inside a task.
+ * @param begin
+ * @param end
+ * @param task called with the index to process and the number of the worker running it
+ */
+void ThreadPool::parallelFor(size_t begin, size_t end,
+                             const std::function<void(size_t, unsigned int)> &task)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    unsigned int workers = (unsigned int) std::min<size_t>(size(), end - begin);
+    size_t chunk = std::max<size_t>(1, (end - begin) / (workers * CHUNKS_PER_WORKER));
+    std::atomic<size_t> next(begin);
+    // the counters live on this stack frame, so we must not return before every worker is done
+    std::mutex doneLock;
+    std::condition_variable doneSignal;
+    unsigned int running = workers;
+    for (unsigned int w = 0; w < workers; w++)
+    {
+        submit([&, w]
+               {
+                   size_t from;
+                   while ((from = next.fetch_add(chunk)) < end)
+                   {
+                       size_t to = std::min(end, from + chunk);
+                       for (size_t i = from; i < to; i++)
+                       {
+                           task(i, w);
+                       }
+                   }
+                   std::lock_guard<std::mutex> guard(doneLock);
+                   if (--running == 0)
+                   {
+                       doneSignal.notify_one();
+                   }
+               });
+    }
+    std::unique_lock<std::mutex> guard(doneLock);
+    doneSignal.wait(guard, [&running] { return running == 0; });
+}
@@ -0,0 +1,69 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_THREADPOOL_H
+#define EX5_THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * a fixed size pool of worker threads, used by the model builders to split their work
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()> > _tasks; // tasks waiting for a free worker
+    std::mutex _lock;
+    std::condition_variable _hasTask; // signaled when a task is queued or the pool stops
+    std::condition_variable _allDone; // signaled when the last running task finishes
+    size_t _pending = 0; // number of queued + running tasks
+    bool _stop = false;
+    /**
+     * the loop each worker runs: pops tasks from the queue until the pool is stopped
+     */
+    void _workerLoop();
+public:
+    /**
+     * starts the workers
+     * @param threads number of workers, 0 means one worker per hardware thread
+     */
+    explicit ThreadPool(unsigned int threads = 0);
+    /**
+     * waits for the queued tasks and joins the workers
+     */
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    /**
+     * @return the number of workers in the pool
+     */
+    unsigned int size() const;
+    /**
+     * queues a task to be run by one of the workers
+     * @param task
+     */
+    void submit(const std::function<void()> &task);
+    /**
+     * blocks until every submitted task has finished
+     */
+    void wait();
+    /**
+     * runs task(i) for every i in [begin, end), splitting the range into chunks between the
+     * workers, and returns once all of them are done
+     * @param begin
+     * @param end
+     * @param task called with the index to process and the number of the worker running it
+     */
+    void parallelFor(size_t begin, size_t end,
+                     const std::function<void(size_t, unsigned int)> &task);
+};
+
+
+#endif //EX5_THREADPOOL_H
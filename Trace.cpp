@@ -0,0 +1,291 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "Trace.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <cstring>
+#include <ios>
+
+#define TRACE_SUCCESS 0
+#define TRACE_FAIL -1
+#define NANOS_PER_MICRO 1000.0
+#define TRACE_PID 1
+
+
+namespace
+{
+    /**
+     * a kept span
+     */
+    struct Event
+    {
+        const char *name;
+        const char *category;
+        uint64_t start; // nanoseconds since the trace started
+        uint64_t duration;
+        char detail[TRACE_DETAIL_BYTES];
+    };
+
+    /**
+     * the ring buffer and nesting state of one thread. the lock is only ever contended by
+     * start and the exports, so keeping a span takes an uncontended lock
+     */
+    struct ThreadBuffer
+    {
+        std::mutex lock;
+        std::vector<Event> events;
+        uint64_t written = 0; // spans kept since the start, the ring's write position
+        unsigned int id;
+        int depth = 0; // spans open on the thread, touched only by it
+        uint64_t roots = 0; // outermost spans seen since the start
+        bool sampled = false; // whether the open outermost span is kept
+    };
+
+    /**
+     * every thread's buffer, never freed so finished threads still export
+     */
+    struct Registry
+    {
+        std::mutex lock;
+        std::vector<ThreadBuffer *> threads;
+        size_t capacity = 0;
+    };
+
+    std::atomic<bool> active(false);
+    std::atomic<unsigned int> sampling(1); // keep one of this many outermost spans
+    std::atomic<int64_t> epoch(0); // the clock's nanoseconds at the start
+
+    /**
+     * @return the registry
+     */
+    Registry &registry()
+    {
+        static Registry *instance = new Registry();
+        return *instance;
+    }
+
+    /**
+     * @return the buffer of the calling thread, registered on first use
+     */
+    ThreadBuffer &localBuffer()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+        if (buffer == nullptr)
+        {
+            buffer = new ThreadBuffer();
+            Registry &all = registry();
+            std::lock_guard<std::mutex> guard(all.lock);
+            buffer->id = (unsigned int) all.threads.size() + 1;
+            buffer->events.resize(all.capacity);
+            all.threads.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    /**
+     * @return the clock in nanoseconds
+     */
+    int64_t clockNanos()
+    {
+        return (int64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @return nanoseconds since the trace started
+     */
+    uint64_t sinceEpoch()
+    {
+        return (uint64_t) (clockNanos() - epoch.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * writes a string as a json string literal
+     * @param out
+     * @param str
+     */
+    void writeString(std::ostream &out, const char *str)
+    {
+        out << '"';
+        for (; *str; str++)
+        {
+            if (*str == '"' || *str == '\\')
+            {
+                out << '\\' << *str;
+            }
+            else if ((unsigned char) *str >= 0x20)
+            {
+                out << *str;
+            }
+        }
+        out << '"';
+    }
+}
+
+/**
+ * @param name a string literal
+ * @param category a string literal, e.g. "query"
+ * @param detail shown with the span, cut to TRACE_DETAIL_BYTES - 1 characters, or null
+ */
+Trace::Span::Span(const char *name, const char *category, const char *detail) :
+        _name(name), _category(category)
+{
+    if (!active.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    ThreadBuffer &buffer = localBuffer();
+    if (buffer.depth++ == 0)
+    {
+        buffer.sampled = buffer.roots++ % sampling.load(std::memory_order_relaxed) == 0;
+    }
+    _entered = true;
+    _kept = buffer.sampled;
+    if (_kept)
+    {
+        _detail[0] = '\0';
+        if (detail != nullptr)
+        {
+            std::strncat(_detail, detail, TRACE_DETAIL_BYTES - 1);
+        }
+        _start = sinceEpoch();
+    }
+}
+
+/**
+ * records the span if it was kept
+ */
+Trace::Span::~Span()
+{
+    if (!_entered)
+    {
+        return;
+    }
+    ThreadBuffer &buffer = localBuffer();
+    buffer.depth--;
+    if (!_kept)
+    {
+        return;
+    }
+    uint64_t end = sinceEpoch();
+    std::lock_guard<std::mutex> guard(buffer.lock);
+    if (buffer.events.empty())
+    {
+        return;
+    }
+    Event &event = buffer.events[buffer.written++ % buffer.events.size()];
+    event.name = _name;
+    event.category = _category;
+    event.start = _start;
+    event.duration = end - _start;
+    std::memcpy(event.detail, _detail, TRACE_DETAIL_BYTES);
+}
+
+/**
+ * @return true if the spans are compiled in
+ */
+bool Trace::enabled()
+{
+#ifdef RECOMMENDER_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * clears the buffers of every thread and starts keeping spans
+ * @param sampleEvery keep one of every sampleEvery outermost spans of each thread, 1 keeps
+ * all of them
+ * @param capacity the spans kept per thread, the oldest are overwritten first
+ */
+void Trace::start(unsigned int sampleEvery, size_t capacity)
+{
+    Registry &all = registry();
+    std::lock_guard<std::mutex> guard(all.lock);
+    all.capacity = capacity;
+    sampling.store((sampleEvery == 0) ? 1 : sampleEvery, std::memory_order_relaxed);
+    epoch.store(clockNanos(), std::memory_order_relaxed);
+    for (ThreadBuffer *buffer : all.threads)
+    {
+        std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+        buffer->events.assign(capacity, Event());
+        buffer->written = 0;
+    }
+    active.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * stops keeping spans, the kept ones stay until the next start
+ */
+void Trace::stop()
+{
+    active.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * writes the kept spans of every thread as a chrome trace event json object
+ * @param out
+ */
+void Trace::writeJson(std::ostream &out)
+{
+    Registry &all = registry();
+    std::lock_guard<std::mutex> guard(all.lock);
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(3); // nanoseconds, in the format's microseconds
+    out << std::fixed;
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    for (ThreadBuffer *buffer : all.threads)
+    {
+        std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+        out << (first ? "" : ",") << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": "
+            << TRACE_PID << ", \"tid\": " << buffer->id << ", \"args\": {\"name\": \"thread "
+            << buffer->id << "\"}}";
+        first = false;
+        size_t size = buffer->events.size();
+        uint64_t oldest = (buffer->written > size) ? buffer->written - size : 0;
+        for (uint64_t i = oldest; i < buffer->written; i++)
+        {
+            const Event &event = buffer->events[i % size];
+            out << ",\n{\"name\": ";
+            writeString(out, event.name);
+            out << ", \"cat\": ";
+            writeString(out, event.category);
+            out << ", \"ph\": \"X\", \"pid\": " << TRACE_PID << ", \"tid\": " << buffer->id
+                << ", \"ts\": " << event.start / NANOS_PER_MICRO << ", \"dur\": "
+                << event.duration / NANOS_PER_MICRO;
+            if (event.detail[0] != '\0')
+            {
+                out << ", \"args\": {\"detail\": ";
+                writeString(out, event.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}" << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+/**
+ * writes the kept spans to a file, see writeJson
+ * @param path
+ * @return 0 upon success, -1 when the file cannot be written
+ */
+int Trace::writeJson(const std::string &path)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        return TRACE_FAIL;
+    }
+    writeJson(out);
+    return out ? TRACE_SUCCESS : TRACE_FAIL;
+}
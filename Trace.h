@@ -0,0 +1,93 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_TRACE_H
+#define EX5_TRACE_H
+
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+#define TRACE_DETAIL_BYTES 48 // the longest detail kept, e.g. the movie a prediction is for
+
+/**
+ * span tracing in the chrome trace event format, which perfetto (ui.perfetto.dev) and
+ * chrome://tracing open. a span covers a load phase, a query or one of its phases, or a thread
+ * pool task, and is kept once it ends as a complete ("X") event in a fixed size ring buffer of
+ * the thread that ran it, so a long run keeps its latest spans in bounded memory.
+ *
+ * tracing starts and stops at run time. while stopped a span costs one relaxed load; while
+ * started, only one of every n outermost spans of a thread is kept, together with everything
+ * nested in it, so it can stay on under load and still show whole queries.
+ *
+ * the spans are compiled in only with RECOMMENDER_TRACE defined (the cmake option of the same
+ * name); without it RECOMMENDER_TRACE_SPAN expands to nothing and the exports are empty.
+ */
+class Trace
+{
+public:
+    /**
+     * one traced span, ending when it goes out of scope
+     */
+    class Span
+    {
+    private:
+        const char *_name;
+        const char *_category;
+        bool _entered = false; // counted in the thread's nesting depth
+        bool _kept = false; // part of a sampled span tree
+        uint64_t _start = 0;
+        char _detail[TRACE_DETAIL_BYTES];
+    public:
+        /**
+         * @param name a string literal
+         * @param category a string literal, e.g. "query"
+         * @param detail shown with the span, cut to TRACE_DETAIL_BYTES - 1 characters, or null
+         */
+        Span(const char *name, const char *category, const char *detail = nullptr);
+        /**
+         * records the span if it was kept
+         */
+        ~Span();
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+    };
+    /**
+     * @return true if the spans are compiled in
+     */
+    static bool enabled();
+    /**
+     * clears the buffers of every thread and starts keeping spans
+     * @param sampleEvery keep one of every sampleEvery outermost spans of each thread, 1 keeps
+     * all of them
+     * @param capacity the spans kept per thread, the oldest are overwritten first
+     */
+    static void start(unsigned int sampleEvery = 1, size_t capacity = 1 << 16);
+    /**
+     * stops keeping spans, the kept ones stay until the next start
+     */
+    static void stop();
+    /**
+     * writes the kept spans of every thread as a chrome trace event json object
+     * @param out
+     */
+    static void writeJson(std::ostream &out);
+    /**
+     * writes the kept spans to a file, see writeJson
+     * @param path
+     * @return 0 upon success, -1 when the file cannot be written
+     */
+    static int writeJson(const std::string &path);
+};
+
+#ifdef RECOMMENDER_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define RECOMMENDER_TRACE_SPAN(...) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(__VA_ARGS__)
+#else
+#define RECOMMENDER_TRACE_SPAN(...) do {} while (false)
+#endif
+
+
+#endif //EX5_TRACE_H
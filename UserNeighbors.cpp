@@ -0,0 +1,182 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#include "UserNeighbors.h"
+#include <cmath>
+#include <algorithm>
+
+#define BUILD_SUCCESS 0
+#define BUILD_FAIL -1
+
+
+/**
+ * builds the inverted index and the neighbors of every client
+ * @param ranks the rank vector of each client, in movie order, where 0.0 means not ranked
+ * @param moviesNum number of movies in every rank vector
+ * @param k number of neighbors to keep for each client
+ * @param pool the workers to build with
+ * @return 0 upon success, -1 upon invalid parameters
+ */
+int UserNeighbors::build(const std::vector<const std::vector<double> *> &ranks,
+                         size_t moviesNum, int k, ThreadPool &pool)
+{
+    if (k <= 0)
+    {
+        return BUILD_FAIL;
+    }
+    _usersNum = ranks.size();
+    _moviesNum = moviesNum;
+    _means.assign(_usersNum, 0.0);
+    _raterOffsets.assign(_moviesNum + 1, 0);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        int n = 0;
+        for (size_t m = 0; m < _moviesNum; m++)
+        {
+            if ((*ranks[u])[m] != 0.0)
+            {
+                _means[u] += (*ranks[u])[m];
+                _raterOffsets[m + 1]++;
+                n++;
+            }
+        }
+        _means[u] = (n == 0) ? 0.0 : _means[u] / n;
+    }
+    for (size_t m = 0; m < _moviesNum; m++)
+    {
+        _raterOffsets[m + 1] += _raterOffsets[m];
+    }
+    // filling by client order keeps the raters of each movie sorted by client index
+    _raters.resize(_raterOffsets[_moviesNum]);
+    _raterRanks.resize(_raterOffsets[_moviesNum]);
+    std::vector<size_t> fill(_raterOffsets.begin(), _raterOffsets.end() - 1);
+    std::vector<double> norms(_usersNum, 0.0);
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        for (size_t m = 0; m < _moviesNum; m++)
+        {
+            if ((*ranks[u])[m] != 0.0)
+            {
+                double centered = (*ranks[u])[m] - _means[u];
+                norms[u] += centered * centered;
+                _raters[fill[m]] = u;
+                _raterRanks[fill[m]++] = centered;
+            }
+        }
+        norms[u] = std::sqrt(norms[u]);
+    }
+    // the neighbors of each client, found in parallel into per client lists
+    std::vector<std::vector<std::pair<double, size_t> > > found(_usersNum);
+    std::vector<std::vector<double> > dots(pool.size(), std::vector<double>(_usersNum, 0.0));
+    std::vector<std::vector<size_t> > touched(pool.size());
+    pool.parallelFor(0, _usersNum, [&](size_t u, unsigned int worker)
+    {
+        std::vector<double> &dot = dots[worker];
+        std::vector<size_t> &seen = touched[worker];
+        for (size_t m = 0; m < _moviesNum; m++)
+        {
+            double centered;
+            if ((*ranks[u])[m] == 0.0 || (centered = (*ranks[u])[m] - _means[u]) == 0.0)
+            {
+                continue;
+            }
+            for (size_t p = _raterOffsets[m]; p < _raterOffsets[m + 1]; p++)
+            {
+                size_t v = _raters[p];
+                if (v != u)
+                {
+                    if (dot[v] == 0.0)
+                    {
+                        seen.push_back(v);
+                    }
+                    dot[v] += centered * _raterRanks[p];
+                }
+            }
+        }
+        std::vector<std::pair<double, size_t> > &cur = found[u];
+        for (size_t v : seen)
+        {
+            if (dot[v] != 0.0)
+            {
+                cur.emplace_back(dot[v] / (norms[u] * norms[v]), v);
+            }
+            dot[v] = 0.0;
+        }
+        seen.clear();
+        size_t keep = std::min(cur.size(), (size_t) k);
+        std::partial_sort(cur.begin(), cur.begin() + keep, cur.end(),
+                          [](const std::pair<double, size_t> &lhs,
+                             const std::pair<double, size_t> &rhs)
+                          {
+                              return lhs.first > rhs.first ||
+                                     (lhs.first == rhs.first && lhs.second < rhs.second);
+                          });
+        cur.resize(keep);
+    });
+    _neighborOffsets.assign(_usersNum + 1, 0);
+    _neighbors.clear();
+    _sims.clear();
+    for (size_t u = 0; u < _usersNum; u++)
+    {
+        for (const std::pair<double, size_t> &neighbor : found[u])
+        {
+            _sims.push_back(neighbor.first);
+            _neighbors.push_back(neighbor.second);
+        }
+        _neighborOffsets[u + 1] = _neighbors.size();
+    }
+    _built = true;
+    return BUILD_SUCCESS;
+}
+
+/**
+ * @return true if build was called successfully
+ */
+bool UserNeighbors::isBuilt() const
+{
+    return _built;
+}
+
+/**
+ * finds the mean centered rank of a client to a movie, using the inverted index
+ * @param user
+ * @param movie
+ * @param rank output, the centered rank if found
+ * @return true if the client ranked the movie
+ */
+bool UserNeighbors::_centeredRank(size_t user, size_t movie, double &rank) const
+{
+    auto first = _raters.begin() + _raterOffsets[movie];
+    auto last = _raters.begin() + _raterOffsets[movie + 1];
+    auto found = std::lower_bound(first, last, user);
+    if (found == last || *found != user)
+    {
+        return false;
+    }
+    rank = _raterRanks[found - _raters.begin()];
+    return true;
+}
+
+/**
+ * predicts the rank of a client to a movie: the client's average rank plus the similarity
+ * weighted average of how the neighbors who ranked the movie deviated from their own average
+ * @param user index of the client in the ranks given to build
+ * @param movie index of the movie
+ * @return the prediction, the client's average rank if no neighbor ranked the movie
+ */
+double UserNeighbors::predict(size_t user, size_t movie) const
+{
+    double numerator = 0.0;
+    double denominator = 0.0;
+    for (size_t p = _neighborOffsets[user]; p < _neighborOffsets[user + 1]; p++)
+    {
+        double rank;
+        if (_centeredRank(_neighbors[p], movie, rank))
+        {
+            numerator += _sims[p] * rank;
+            denominator += std::fabs(_sims[p]);
+        }
+    }
+    return (denominator == 0.0) ? _means[user] : _means[user] + numerator / denominator;
+}
@@ -0,0 +1,64 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_USERNEIGHBORS_H
+#define EX5_USERNEIGHBORS_H
+
+#include <vector>
+#include "ThreadPool.h"
+
+/**
+ * user based collaborative filtering: caches for every client the k clients most similar to
+ * them, by the cosine of their mean centered ranks. the similarities are accumulated through an
+ * inverted index from each movie to the clients who ranked it, so building the neighbors of a
+ * client only touches the clients who share at least one ranked movie with them.
+ */
+class UserNeighbors
+{
+private:
+    size_t _usersNum = 0;
+    size_t _moviesNum = 0;
+    bool _built = false;
+    std::vector<double> _means; // average rank of each client
+    std::vector<size_t> _raterOffsets; // range of each movie in _raters and _raterRanks
+    std::vector<size_t> _raters; // the inverted index: clients who ranked each movie
+    std::vector<double> _raterRanks; // their mean centered rank of that movie
+    std::vector<size_t> _neighborOffsets; // range of each client in _neighbors and _sims
+    std::vector<size_t> _neighbors; // the cached neighbors of each client, most similar first
+    std::vector<double> _sims; // the similarity of each cached neighbor
+    /**
+     * finds the mean centered rank of a client to a movie, using the inverted index
+     * @param user
+     * @param movie
+     * @param rank output, the centered rank if found
+     * @return true if the client ranked the movie
+     */
+    bool _centeredRank(size_t user, size_t movie, double &rank) const;
+public:
+    /**
+     * builds the inverted index and the neighbors of every client
+     * @param ranks the rank vector of each client, in movie order, where 0.0 means not ranked
+     * @param moviesNum number of movies in every rank vector
+     * @param k number of neighbors to keep for each client
+     * @param pool the workers to build with
+     * @return 0 upon success, -1 upon invalid parameters
+     */
+    int build(const std::vector<const std::vector<double> *> &ranks, size_t moviesNum, int k,
+              ThreadPool &pool);
+    /**
+     * @return true if build was called successfully
+     */
+    bool isBuilt() const;
+    /**
+     * predicts the rank of a client to a movie: the client's average rank plus the similarity
+     * weighted average of how the neighbors who ranked the movie deviated from their own average
+     * @param user index of the client in the ranks given to build
+     * @param movie index of the movie
+     * @return the prediction, the client's average rank if no neighbor ranked the movie
+     */
+    double predict(size_t user, size_t movie) const;
+};
+
+
+#endif //EX5_USERNEIGHBORS_H
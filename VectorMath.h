@@ -0,0 +1,157 @@
+//
+// Created by michael on 19/10/2026.
+//
+
+#ifndef EX5_VECTORMATH_H
+#define EX5_VECTORMATH_H
+
+#include <cstddef>
+#include <cmath>
+
+/**
+ * dense vector kernels shared by the model builders. the loops keep four independent
+ * accumulators so the compiler can keep them in separate SIMD lanes, except for the exact
+ * kernels, which sum in index order so their results match the recommender's own scores bit
+ * for bit.
+ */
+namespace VectorMath
+{
+    /**
+     * dot product of two contiguous vectors, summed in index order
+     * @param a first vector
+     * @param b second vector
+     * @param n length of both vectors
+     * @return the dot product
+     */
+    inline double exactDotProd(const double *a, const double *b, size_t n)
+    {
+        double out = 0.0;
+        for (size_t j = 0; j < n; j++)
+        {
+            out += a[j] * b[j];
+        }
+        return out;
+    }
+
+    /**
+     * norm of a contiguous vector, summed in index order
+     * @param a
+     * @param n length of the vector
+     * @return the norm of a
+     */
+    inline double exactNorm(const double *a, size_t n)
+    {
+        return std::sqrt(exactDotProd(a, a, n));
+    }
+
+    /**
+     * exactDotProd for vectors of a length known at compile time, so the loop is fully unrolled
+     * and the multiplications vectorized, while the sum keeps the same order
+     * @tparam N length of both vectors
+     * @param a first vector
+     * @param b second vector
+     * @return the dot product
+     */
+    template<size_t N>
+    inline double fixedDotProd(const double *a, const double *b, size_t)
+    {
+        double out = 0.0;
+        for (size_t j = 0; j < N; j++)
+        {
+            out += a[j] * b[j];
+        }
+        return out;
+    }
+
+    /**
+     * exactNorm for vectors of a length known at compile time
+     * @tparam N length of the vector
+     * @param a
+     * @return the norm of a
+     */
+    template<size_t N>
+    inline double fixedNorm(const double *a, size_t)
+    {
+        return std::sqrt(fixedDotProd<N>(a, a, N));
+    }
+
+    /**
+     * the exact kernels to use for vectors of a certain length
+     */
+    struct ExactKernels
+    {
+        size_t dims; // the length the kernels were picked for
+        double (*dotProd)(const double *a, const double *b, size_t n);
+        double (*norm)(const double *a, size_t n);
+    };
+
+    /**
+     * picks the exact kernels for a vector length, once per loaded dataset: a specialized pair
+     * for the common attribute counts, and the generic loops for any other length
+     * @param dims
+     * @return the kernels
+     */
+    inline ExactKernels exactKernelsFor(size_t dims)
+    {
+        static const ExactKernels table[] = {{4, fixedDotProd<4>, fixedNorm<4>},
+                                             {5, fixedDotProd<5>, fixedNorm<5>},
+                                             {8, fixedDotProd<8>, fixedNorm<8>},
+                                             {16, fixedDotProd<16>, fixedNorm<16>},
+                                             {32, fixedDotProd<32>, fixedNorm<32>},
+                                             {64, fixedDotProd<64>, fixedNorm<64>},
+                                             {120, fixedDotProd<120>, fixedNorm<120>},
+                                             {128, fixedDotProd<128>, fixedNorm<128>}};
+        for (const ExactKernels &kernels : table)
+        {
+            if (kernels.dims == dims)
+            {
+                return kernels;
+            }
+        }
+        ExactKernels generic = {dims, exactDotProd, exactNorm};
+        return generic;
+    }
+
+    /**
+     * dot product of two contiguous vectors
+     * @param a first vector
+     * @param b second vector
+     * @param n length of both vectors
+     * @return the dot product
+     */
+    inline double dotProd(const double *a, const double *b, size_t n)
+    {
+        double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+        size_t j = 0;
+        for (; j + 4 <= n; j += 4)
+        {
+            acc0 += a[j] * b[j];
+            acc1 += a[j + 1] * b[j + 1];
+            acc2 += a[j + 2] * b[j + 2];
+            acc3 += a[j + 3] * b[j + 3];
+        }
+        for (; j < n; j++)
+        {
+            acc0 += a[j] * b[j];
+        }
+        return (acc0 + acc1) + (acc2 + acc3);
+    }
+
+    /**
+     * adds scalar * x to y, element by element
+     * @param scalar
+     * @param x
+     * @param y the vector to update
+     * @param n length of both vectors
+     */
+    inline void axpy(double scalar, const double *x, double *y, size_t n)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            y[j] += scalar * x[j];
+        }
+    }
+}
+
+
+#endif //EX5_VECTORMATH_H
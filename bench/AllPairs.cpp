@@ -0,0 +1,151 @@
+//
+// Created by michael on 19/10/2026.
+//
+// times the tiled all pairs similarity builder against a plain double loop over the pairs, and
+// checks that both give the same cosines. the catalog can be repeated to time bigger ones.
+//
+// usage: all_pairs <movies file> [copies] [tile] [tiles file]
+// e.g. all_pairs movies_big.txt 8 64 /tmp/similarities.bin
+//
+
+#include "SimilarityTiles.h"
+#include "VectorMath.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+#define DEFAULT_COPIES 1
+#define DEFAULT_TILE 64
+
+typedef std::chrono::steady_clock benchClock;
+
+/**
+ * reads the movie attribute vectors
+ * @param path
+ * @return the vectors in file order
+ */
+std::vector<std::vector<double> > readAttributes(const std::string &path)
+{
+    std::vector<std::vector<double> > movies;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string name;
+        double val;
+        if (!(lineStream >> name))
+        {
+            continue;
+        }
+        movies.emplace_back();
+        while (lineStream >> val)
+        {
+            movies.back().push_back(val);
+        }
+    }
+    return movies;
+}
+
+/**
+ * @param start
+ * @return the milliseconds passed since start
+ */
+double millisSince(benchClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(benchClock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: all_pairs <movies file> [copies] [tile] [tiles file]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t copies = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : DEFAULT_COPIES;
+    size_t tileSize = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : DEFAULT_TILE;
+    std::vector<std::vector<double> > attributes = readAttributes(argv[1]);
+    if (attributes.empty())
+    {
+        std::cerr << "No movies in " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<const std::vector<double> *> rows;
+    for (size_t copy = 0; copy < copies; copy++)
+    {
+        for (const std::vector<double> &vec : attributes)
+        {
+            rows.push_back(&vec);
+        }
+    }
+    size_t moviesNum = rows.size();
+    size_t dims = attributes[0].size();
+    std::cout << "movies: " << moviesNum << ", attributes: " << dims << std::endl;
+
+    // the plain loop, one pair at a time
+    benchClock::time_point start = benchClock::now();
+    VectorMath::ExactKernels kernels = VectorMath::exactKernelsFor(dims);
+    std::vector<double> norms(moviesNum);
+    for (size_t i = 0; i < moviesNum; i++)
+    {
+        norms[i] = kernels.norm(rows[i]->data(), dims);
+    }
+    std::vector<double> plain(moviesNum * moviesNum);
+    for (size_t i = 0; i < moviesNum; i++)
+    {
+        for (size_t j = 0; j < moviesNum; j++)
+        {
+            plain[i * moviesNum + j] = kernels.dotProd(rows[i]->data(), rows[j]->data(), dims) /
+                                       (norms[j] * norms[i]);
+        }
+    }
+    std::cout << "plain loop: " << millisSince(start) << " ms" << std::endl;
+
+    SimilarityTiles tiles(tileSize);
+    std::vector<double> matrix;
+    for (unsigned int threads : {1u, 0u})
+    {
+        ThreadPool pool(threads);
+        start = benchClock::now();
+        tiles.toMatrix(rows, pool, matrix);
+        std::cout << "tiles, " << pool.size() << " threads: " << millisSince(start) << " ms"
+                  << std::endl;
+    }
+    size_t mismatches = 0;
+    for (size_t p = 0; p < matrix.size(); p++)
+    {
+        mismatches += (matrix[p] != plain[p]);
+    }
+    std::cout << "cosines differing from the plain loop: " << mismatches << std::endl;
+
+    if (argc > 4)
+    {
+        ThreadPool pool;
+        start = benchClock::now();
+        if (tiles.toFile(rows, pool, argv[4]) != 0)
+        {
+            std::cerr << "Unable to write " << argv[4] << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "tiles to file: " << millisSince(start) << " ms" << std::endl;
+        size_t readMovies = 0;
+        size_t readMismatches = 0;
+        SimilarityTiles::readFile(argv[4], [&](const SimilarityTile &tile, unsigned int)
+        {
+            for (size_t r = 0; r < tile.rows; r++)
+            {
+                for (size_t c = 0; c < tile.cols; c++)
+                {
+                    size_t cell = (tile.rowBegin + r) * moviesNum + tile.colBegin + c;
+                    readMismatches += (tile.at(r, c) != plain[cell]);
+                }
+            }
+        }, readMovies);
+        std::cout << "cosines read back differing: " << readMismatches << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
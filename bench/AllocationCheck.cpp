@@ -0,0 +1,251 @@
+//
+// Created by michael on 19/10/2026.
+//
+// checks that the queries take no memory from the heap once warmed up: the per query
+// temporaries come from the thread's QueryArena, which stops growing after the first queries.
+// every query of the stream is answered once to warm up, then again while operator new counts
+// the allocations; the only allocations allowed are the returned list of the filtered queries
+// and the copies of returned movie names too long for the short string buffer. besides the
+// plain scans, the stream covers recommendByContent through the content clusters, the hybrid
+// recommendation, and the filtered queries with and without the attribute index. exits with a
+// failure if any query allocated more.
+//
+// usage: allocation_check <movies file> <ranks file> [clients] [k]
+// e.g. allocation_check movies_big.txt ranks_big.txt 20 5
+//
+
+#include "RecommenderSystem.h"
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <cmath>
+
+#define DEFAULT_CLIENTS 20
+#define DEFAULT_K 5
+#define PREDICTIONS_PER_CLIENT 10
+#define TYPES_NUM 8
+#define CLUSTERS 20
+#define HYBRID_WEIGHT 0.5
+#define FILTERED_N 5
+
+std::atomic<size_t> allocations(0);
+
+/**
+ * counts every allocation of the program
+ * @param size
+ * @return the memory
+ */
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *out = std::malloc(size == 0 ? 1 : size);
+    if (out == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return out;
+}
+
+/**
+ * @param ptr memory of operator new
+ */
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+/**
+ * @param ptr memory of operator new
+ */
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+/**
+ * one query of the stream
+ */
+struct Query
+{
+    int type; // index in TYPE_NAMES
+    std::string movie;
+    std::string client;
+    int k; // at most the client's ranks, as the queries require
+};
+
+const char *const TYPE_NAMES[] = {"recommendByContent", "predictMovieScoreForUser",
+                                  "recommendByCF", "recommendByContent (clusters)",
+                                  "recommendHybrid", "filtered recommendByContent",
+                                  "filtered recommendByCF",
+                                  "filtered recommendByContent (attribute index)"};
+
+// the movies whose first attribute is at least 3 and second at most 8
+const std::vector<AttributeFilter> FILTERS = {{0, 3.0, HUGE_VAL}, {1, -HUGE_VAL, 8.0}};
+
+/**
+ * reads the movie and client names out of a ranks file
+ * @param path
+ * @param movies output, the movie names
+ * @param clients output, the client names in file order
+ * @param ranked output, the number of movies each client ranked
+ * @return true upon success
+ */
+bool readNames(const std::string &path, std::vector<std::string> &movies,
+               std::vector<std::string> &clients, std::vector<int> &ranked)
+{
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line))
+    {
+        return false;
+    }
+    std::istringstream movieStream(line);
+    std::string name;
+    while (movieStream >> name)
+    {
+        movies.push_back(name);
+    }
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        if (lineStream >> name)
+        {
+            clients.push_back(name);
+            ranked.push_back(0);
+            std::string rank;
+            while (lineStream >> rank)
+            {
+                ranked.back() += (rank != "NA");
+            }
+        }
+    }
+    return !movies.empty();
+}
+
+/**
+ * @param name
+ * @return 1 if a copy of name takes memory from the heap, 0 otherwise
+ */
+size_t nameAllocations(const std::string &name)
+{
+    return (name.size() > std::string().capacity()) ? 1 : 0;
+}
+
+/**
+ * answers a query
+ * @param rs the recommender with no model built
+ * @param built the same data, with the content clusters and the attribute index built
+ * @param query
+ * @return the heap allocations the answer may take, for the returned names
+ */
+size_t answer(RecommenderSystem &rs, RecommenderSystem &built, const Query &query)
+{
+    std::vector<std::string> names;
+    switch (query.type)
+    {
+        case 0:
+            return nameAllocations(rs.recommendByContent(query.client));
+        case 1:
+            rs.predictMovieScoreForUser(query.movie, query.client, query.k);
+            return 0;
+        case 2:
+            return nameAllocations(rs.recommendByCF(query.client, query.k));
+        case 3:
+            return nameAllocations(built.recommendByContent(query.client));
+        case 4:
+            return nameAllocations(rs.recommendHybrid(query.client, query.k, HYBRID_WEIGHT));
+        case 5:
+            names = rs.recommendByContent(query.client, FILTERS, FILTERED_N);
+            break;
+        case 6:
+            names = rs.recommendByCF(query.client, query.k, FILTERS, FILTERED_N);
+            break;
+        default:
+            names = built.recommendByContent(query.client, FILTERS, FILTERED_N);
+            break;
+    }
+    size_t allowed = names.empty() ? 0 : 1; // the list itself
+    for (const std::string &name : names)
+    {
+        allowed += nameAllocations(name);
+    }
+    return allowed;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: allocation_check <movies file> <ranks file> [clients] [k]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    int clientsNum = (argc > 3) ? std::atoi(argv[3]) : DEFAULT_CLIENTS;
+    int k = (argc > 4) ? std::atoi(argv[4]) : DEFAULT_K;
+    RecommenderSystem rs;
+    RecommenderSystem built;
+    std::vector<std::string> movies;
+    std::vector<std::string> clients;
+    std::vector<int> ranked;
+    if (rs.loadData(argv[1], argv[2]) != 0 || built.loadData(argv[1], argv[2]) != 0 ||
+        built.buildContentClusters(CLUSTERS) != 0 || built.buildAttributeIndex() != 0 ||
+        !readNames(argv[2], movies, clients, ranked))
+    {
+        return EXIT_FAILURE;
+    }
+    std::vector<Query> queries;
+    for (size_t c = 0; c < clients.size() && c < (size_t) clientsNum; c++)
+    {
+        int clientK = std::min(k, ranked[c]);
+        if (clientK <= 0)
+        {
+            continue;
+        }
+        queries.push_back({0, "", clients[c], clientK});
+        for (size_t p = 0; p < PREDICTIONS_PER_CLIENT; p++)
+        {
+            queries.push_back({1, movies[(c * PREDICTIONS_PER_CLIENT + p) % movies.size()],
+                               clients[c], clientK});
+        }
+        for (int type = 2; type < TYPES_NUM; type++)
+        {
+            queries.push_back({type, "", clients[c], clientK});
+        }
+    }
+    for (const Query &query : queries) // warm up, the arena grows to the largest query
+    {
+        answer(rs, built, query);
+    }
+    size_t counted[TYPES_NUM] = {0};
+    size_t excess[TYPES_NUM] = {0};
+    size_t failed = 0;
+    for (const Query &query : queries)
+    {
+        size_t before = allocations.load(std::memory_order_relaxed);
+        size_t allowed = answer(rs, built, query);
+        size_t taken = allocations.load(std::memory_order_relaxed) - before;
+        counted[query.type]++;
+        if (taken > allowed)
+        {
+            excess[query.type] += taken - allowed;
+            failed++;
+        }
+    }
+    for (int t = 0; t < TYPES_NUM; t++)
+    {
+        std::cout << TYPE_NAMES[t] << ": " << counted[t] << " queries, " << excess[t]
+                  << " heap allocations beyond the returned names" << std::endl;
+    }
+    std::cout << "arena: " << QueryArena::local().capacity() / 1024 << " KB in "
+              << QueryArena::local().heapAllocations() << " blocks" << std::endl;
+    if (failed != 0)
+    {
+        std::cout << failed << " queries allocated in steady state" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "no query allocated in steady state" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,608 @@
+//
+// Created by michael on 19/10/2026.
+//
+// latency benchmark of the hot paths: loadData, the exact dot product and norm kernels, and the
+// recommendByContent, predictMovieScoreForUser and recommendByCF queries, and the predictions again
+// through the handle overload. every measurement runs warmup rounds first, then the given
+// repetitions, and reports the mean and percentiles of the repetitions, as a table and optionally
+// as json for tracking regressions. built with RECOMMENDER_METRICS, it also reports the
+// recommender's own histograms of every dataset, and built with RECOMMENDER_TRACE, --trace writes
+// the spans of one of every n outermost calls as chrome trace event json, for ui.perfetto.dev.
+// --perf adds the hardware counters of every repetition (cycles, instructions, cache and branch
+// misses, see PerfCounters.h) to the report, where the kernel allows perf events. the counters
+// are of the calling thread, so a measurement that also ran on the recommender's workers, as
+// loadData does for a ranks file of a few parse chunks, is marked as counted on the calling
+// thread only.
+//
+// usage: recommender_bench [--dir <data dir>] [--warmup n] [--reps n] [--k k] [--json <file>]
+//                          [--trace <file>] [--trace-sample n] [--perf]
+//                          [<name> <movies file> <ranks file>]...
+// with no datasets given, runs small (movies_small.txt, ranks_small.txt), medium
+// (movies_features.txt, ranks_matrix.txt) and big (movies_big.txt, ranks_big.txt) from the data
+// dir, e.g. recommender_bench --dir .. --reps 50 --json bench.json
+//
+
+#include "RecommenderSystem.h"
+#include "VectorMath.h"
+#include "PerfCounters.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <memory>
+
+#define DEFAULT_WARMUP 3
+#define DEFAULT_REPS 20
+#define DEFAULT_K 5
+#define KERNEL_BATCH 1000 // kernel calls per repetition, a single call is below the clock's grain
+
+typedef std::chrono::steady_clock benchClock;
+
+PerfCounters *hardwareCounters = nullptr; // read around every repetition, set by --perf
+
+/**
+ * the input files of a dataset
+ */
+struct Dataset
+{
+    std::string name;
+    std::string movies;
+    std::string ranks;
+};
+
+/**
+ * the repetitions of one measured operation
+ */
+struct Measurement
+{
+    std::string name;
+    std::vector<double> micros; // the time of every repetition
+    double bytes; // input bytes per repetition, 0 when throughput does not apply
+    double counters[PerfCounters::EVENTS_NUM]; // the sum of every counter over the repetitions
+    int counted[PerfCounters::EVENTS_NUM]; // the repetitions whose counter could be read
+    bool callingThreadOnly; // the operation ran on the workers too, which the counters miss
+};
+
+/**
+ * the measurements of one dataset
+ */
+struct DatasetResult
+{
+    Dataset dataset;
+    size_t moviesNum;
+    size_t clientsNum;
+    std::vector<Measurement> measurements;
+    std::string metricsText; // the recommender's own histograms, see Metrics.h
+    std::string metricsJson;
+};
+
+/**
+ * reads the names out of the first column of a file
+ * @param path
+ * @param skipHeader true for a ranks file, whose first line holds the movie names
+ * @return the names in file order
+ */
+std::vector<std::string> readNames(const std::string &path, bool skipHeader)
+{
+    std::vector<std::string> names;
+    std::ifstream file(path);
+    std::string line;
+    if (skipHeader)
+    {
+        std::getline(file, line);
+    }
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string name;
+        if (lineStream >> name)
+        {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+/**
+ * counts the movies every client ranked
+ * @param path a ranks file
+ * @return the counts, in the order of the client lines
+ */
+std::vector<int> readRankedCounts(const std::string &path)
+{
+    std::vector<int> counts;
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string val;
+        if (!(lineStream >> val))
+        {
+            continue;
+        }
+        int count = 0;
+        while (lineStream >> val)
+        {
+            count += (val != "NA");
+        }
+        counts.push_back(count);
+    }
+    return counts;
+}
+
+/**
+ * @param path
+ * @return the size of the file in bytes, 0 if it cannot be opened
+ */
+double fileBytes(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? (double) file.tellg() : 0.0;
+}
+
+/**
+ * @param start
+ * @return the microseconds passed since start
+ */
+double microsSince(benchClock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(benchClock::now() - start).count();
+}
+
+/**
+ * runs an operation warmup times unmeasured, then reps times measured
+ * @param name
+ * @param warmup
+ * @param reps
+ * @param op called with the repetition number, warmup rounds included
+ * @return the measurement
+ */
+template<class Op>
+Measurement measure(const std::string &name, int warmup, int reps, Op op)
+{
+    Measurement out = {name, {}, 0.0, {}, {}, false};
+    for (int i = 0; i < warmup; i++)
+    {
+        op(i);
+    }
+    for (int i = 0; i < reps; i++)
+    {
+        if (hardwareCounters != nullptr)
+        {
+            hardwareCounters->start();
+        }
+        benchClock::time_point start = benchClock::now();
+        op(warmup + i);
+        out.micros.push_back(microsSince(start));
+        if (hardwareCounters != nullptr)
+        {
+            PerfCounters::Sample sample = hardwareCounters->stop();
+            for (int e = 0; e < PerfCounters::EVENTS_NUM; e++)
+            {
+                out.counters[e] += sample.values[e];
+                out.counted[e] += sample.valid[e];
+            }
+        }
+    }
+    return out;
+}
+
+/**
+ * @param sorted the samples, in increasing order
+ * @param fraction between 0 and 1
+ * @return the nearest rank percentile
+ */
+double percentile(const std::vector<double> &sorted, double fraction)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    size_t rank = (size_t) (fraction * sorted.size() + 0.5);
+    return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+/**
+ * the summary of a measurement
+ */
+struct Summary
+{
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+/**
+ * @param measurement
+ * @return the mean and percentiles of its repetitions
+ */
+Summary summarize(const Measurement &measurement)
+{
+    std::vector<double> sorted(measurement.micros);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double micros : sorted)
+    {
+        sum += micros;
+    }
+    Summary out = {sorted.empty() ? 0.0 : sum / sorted.size(), percentile(sorted, 0.5),
+                   percentile(sorted, 0.9), percentile(sorted, 0.99),
+                   sorted.empty() ? 0.0 : sorted.back()};
+    return out;
+}
+
+/**
+ * measures every hot path on a dataset
+ * @param dataset
+ * @param warmup
+ * @param reps
+ * @param k the k of the cf queries
+ * @param result output
+ * @return true upon success, false if the dataset cannot be loaded
+ */
+bool runDataset(const Dataset &dataset, int warmup, int reps, int k, DatasetResult &result)
+{
+    Metrics::reset();
+    RecommenderSystem rs;
+    if (rs.loadData(dataset.movies, dataset.ranks) != 0)
+    {
+        return false;
+    }
+    std::vector<std::string> clients = readNames(dataset.ranks, true);
+    std::vector<std::string> movies = readNames(dataset.movies, false);
+    std::map<std::string, std::vector<double> > attributes;
+    {
+        std::ifstream file(dataset.movies);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream lineStream(line);
+            std::string name;
+            double val;
+            lineStream >> name;
+            while (lineStream >> val)
+            {
+                attributes[name].push_back(val);
+            }
+        }
+    }
+    if (clients.empty() || movies.empty())
+    {
+        return false;
+    }
+    result.dataset = dataset;
+    result.moviesNum = movies.size();
+    result.clientsNum = clients.size();
+
+    bool loadUsedWorkers = false;
+    Measurement load = measure("loadData", warmup, reps, [&dataset, &loadUsedWorkers](int)
+    {
+        RecommenderSystem fresh;
+        fresh.loadData(dataset.movies, dataset.ranks);
+        loadUsedWorkers = loadUsedWorkers || fresh.workersStarted();
+    });
+    load.bytes = fileBytes(dataset.movies) + fileBytes(dataset.ranks);
+    load.callingThreadOnly = loadUsedWorkers;
+    result.measurements.push_back(load);
+
+    // the kernels the recommender picked for the attribute count, cycling through the movies
+    std::vector<const double *> rows;
+    for (const std::string &movie : movies)
+    {
+        rows.push_back(attributes[movie].data());
+    }
+    size_t dims = attributes[movies[0]].size();
+    VectorMath::ExactKernels kernels = VectorMath::exactKernelsFor(dims);
+    volatile double sink = 0.0;
+    result.measurements.push_back(measure("dotProd x" + std::to_string(KERNEL_BATCH), warmup,
+                                          reps, [&](int)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < KERNEL_BATCH; i++)
+        {
+            sum += kernels.dotProd(rows[i % rows.size()], rows[(i + 1) % rows.size()], dims);
+        }
+        sink = sink + sum;
+    }));
+    result.measurements.push_back(measure("norm x" + std::to_string(KERNEL_BATCH), warmup, reps,
+                                          [&](int)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < KERNEL_BATCH; i++)
+        {
+            sum += kernels.norm(rows[i % rows.size()], dims);
+        }
+        sink = sink + sum;
+    }));
+
+    // the queries cycle through the clients, and through the movies in a different order
+    result.measurements.push_back(measure("recommendByContent", warmup, reps, [&](int i)
+    {
+        rs.recommendByContent(clients[i % clients.size()]);
+    }));
+    // the prediction needs at least k ranked movies, so k is capped by the client's count
+    std::vector<int> ranked = readRankedCounts(dataset.ranks);
+    result.measurements.push_back(measure("predictMovieScoreForUser", warmup, reps, [&](int i)
+    {
+        size_t client = i % clients.size();
+        rs.predictMovieScoreForUser(movies[(i * 7) % movies.size()], clients[client],
+                                    std::min(k, ranked[client]));
+    }));
+    result.measurements.push_back(measure("recommendByCF", warmup, reps, [&](int i)
+    {
+        size_t client = i % clients.size();
+        rs.recommendByCF(clients[client], std::min(k, ranked[client]));
+    }));
+    // the same predictions with the names resolved once, as a caller holding handles makes them
+    std::vector<UserHandle> clientHandles;
+    std::vector<MovieHandle> movieHandles;
+    for (const std::string &client : clients)
+    {
+        clientHandles.push_back(rs.lookupUser(client));
+    }
+    for (const std::string &movie : movies)
+    {
+        movieHandles.push_back(rs.lookupMovie(movie));
+    }
+    result.measurements.push_back(measure("predictMovieScoreForUser by handle", warmup, reps,
+                                          [&](int i)
+    {
+        size_t client = i % clients.size();
+        rs.predictMovieScoreForUser(movieHandles[(i * 7) % movies.size()],
+                                    clientHandles[client], std::min(k, ranked[client]));
+    }));
+    if (Metrics::enabled())
+    {
+        result.metricsText = Metrics::toText();
+        result.metricsJson = Metrics::toJson();
+    }
+    return true;
+}
+
+/**
+ * @param measurement
+ * @return true if any of its counters could be read
+ */
+bool countedAny(const Measurement &measurement)
+{
+    for (int e = 0; e < PerfCounters::EVENTS_NUM; e++)
+    {
+        if (measurement.counted[e] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * prints the results as a table
+ * @param results
+ */
+void printTable(const std::vector<DatasetResult> &results)
+{
+    for (const DatasetResult &result : results)
+    {
+        std::cout << result.dataset.name << " (" << result.moviesNum << " movies, "
+                  << result.clientsNum << " clients), microseconds:" << std::endl;
+        for (const Measurement &measurement : result.measurements)
+        {
+            Summary summary = summarize(measurement);
+            std::cout << "  " << measurement.name << ": mean " << summary.mean << ", p50 "
+                      << summary.p50 << ", p90 " << summary.p90 << ", p99 " << summary.p99
+                      << ", max " << summary.max;
+            if (measurement.bytes != 0.0 && summary.p50 != 0.0)
+            {
+                std::cout << ", " << measurement.bytes / summary.p50 << " MB/s";
+            }
+            for (int e = 0; e < PerfCounters::EVENTS_NUM; e++)
+            {
+                if (measurement.counted[e] != 0)
+                {
+                    std::cout << ", " << PerfCounters::name((PerfCounters::Event) e) << " "
+                              << measurement.counters[e] / measurement.counted[e];
+                }
+            }
+            if (measurement.counted[PerfCounters::CYCLES] != 0 &&
+                measurement.counted[PerfCounters::INSTRUCTIONS] != 0 &&
+                measurement.counters[PerfCounters::CYCLES] != 0.0)
+            {
+                std::cout << ", ipc " << (measurement.counters[PerfCounters::INSTRUCTIONS] /
+                                          measurement.counted[PerfCounters::INSTRUCTIONS]) /
+                                         (measurement.counters[PerfCounters::CYCLES] /
+                                          measurement.counted[PerfCounters::CYCLES]);
+            }
+            if (measurement.callingThreadOnly && countedAny(measurement))
+            {
+                std::cout << " (counters of the calling thread only)";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << result.metricsText;
+    }
+}
+
+/**
+ * writes the results as json
+ * @param results
+ * @param warmup
+ * @param reps
+ * @param out
+ */
+void printJson(const std::vector<DatasetResult> &results, int warmup, int reps,
+               std::ostream &out)
+{
+    out << "{\n  \"warmup\": " << warmup << ",\n  \"reps\": " << reps
+        << ",\n  \"unit\": \"us\",\n  \"datasets\": [";
+    for (size_t d = 0; d < results.size(); d++)
+    {
+        const DatasetResult &result = results[d];
+        out << (d ? "," : "") << "\n    {\"name\": \"" << result.dataset.name
+            << "\", \"movies\": " << result.moviesNum << ", \"clients\": " << result.clientsNum
+            << ", \"results\": [";
+        for (size_t m = 0; m < result.measurements.size(); m++)
+        {
+            const Measurement &measurement = result.measurements[m];
+            Summary summary = summarize(measurement);
+            out << (m ? "," : "") << "\n      {\"name\": \"" << measurement.name
+                << "\", \"mean\": " << summary.mean << ", \"p50\": " << summary.p50
+                << ", \"p90\": " << summary.p90 << ", \"p99\": " << summary.p99
+                << ", \"max\": " << summary.max;
+            if (measurement.bytes != 0.0 && summary.p50 != 0.0)
+            {
+                out << ", \"mbPerSecond\": " << measurement.bytes / summary.p50;
+            }
+            for (int e = 0; e < PerfCounters::EVENTS_NUM; e++)
+            {
+                if (measurement.counted[e] != 0)
+                { // per repetition, e.g. "cacheMisses"
+                    std::string key = PerfCounters::name((PerfCounters::Event) e);
+                    size_t space = key.find(' ');
+                    if (space != std::string::npos)
+                    {
+                        key.erase(space, 1);
+                        key[space] = (char) std::toupper(key[space]);
+                    }
+                    out << ", \"" << key << "\": "
+                        << measurement.counters[e] / measurement.counted[e];
+                }
+            }
+            if (measurement.callingThreadOnly && countedAny(measurement))
+            {
+                out << ", \"countersScope\": \"calling thread only\"";
+            }
+            out << "}";
+        }
+        out << "\n    ]";
+        if (!result.metricsJson.empty())
+        {
+            out << ",\n     \"metrics\": " << result.metricsJson;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string dir = ".";
+    std::string jsonPath;
+    std::string tracePath;
+    unsigned int traceSample = 1;
+    bool perf = false;
+    int warmup = DEFAULT_WARMUP;
+    int reps = DEFAULT_REPS;
+    int k = DEFAULT_K;
+    std::vector<Dataset> datasets;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--dir") && hasValue)
+        {
+            dir = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--warmup") && hasValue)
+        {
+            warmup = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--reps") && hasValue)
+        {
+            reps = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--k") && hasValue)
+        {
+            k = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--json") && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--trace") && hasValue)
+        {
+            tracePath = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--trace-sample") && hasValue)
+        {
+            traceSample = (unsigned int) std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--perf"))
+        {
+            perf = true;
+        }
+        else if (argv[i][0] != '-' && i + 2 < argc)
+        {
+            Dataset dataset = {argv[i], argv[i + 1], argv[i + 2]};
+            datasets.push_back(dataset);
+            i += 2;
+        }
+        else
+        {
+            std::cerr << "Usage: recommender_bench [--dir <data dir>] [--warmup n] [--reps n] "
+                         "[--k k] [--json <file>] [--trace <file>] [--trace-sample n] [--perf] "
+                         "[<name> <movies file> <ranks file>]..."
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (datasets.empty())
+    {
+        datasets.push_back({"small", dir + "/movies_small.txt", dir + "/ranks_small.txt"});
+        datasets.push_back({"medium", dir + "/movies_features.txt", dir + "/ranks_matrix.txt"});
+        datasets.push_back({"big", dir + "/movies_big.txt", dir + "/ranks_big.txt"});
+    }
+    std::unique_ptr<PerfCounters> counters;
+    if (perf)
+    {
+        counters.reset(new PerfCounters());
+        if (!counters->error().empty())
+        {
+            std::cerr << "Hardware counters " << (counters->available() ? "partly" : "not")
+                      << " available, " << counters->error() << std::endl;
+        }
+        hardwareCounters = counters->available() ? counters.get() : nullptr;
+    }
+    if (!tracePath.empty())
+    {
+        if (!Trace::enabled())
+        {
+            std::cerr << "Built without RECOMMENDER_TRACE, the trace will be empty" << std::endl;
+        }
+        Trace::start(traceSample);
+    }
+    std::vector<DatasetResult> results;
+    for (const Dataset &dataset : datasets)
+    {
+        DatasetResult result;
+        if (!runDataset(dataset, warmup, reps, k, result))
+        {
+            std::cerr << "Unable to load " << dataset.name << std::endl;
+            return EXIT_FAILURE;
+        }
+        results.push_back(result);
+    }
+    printTable(results);
+    Trace::stop();
+    if (!tracePath.empty() && Trace::writeJson(tracePath) != 0)
+    {
+        std::cerr << "Unable to open file " << tracePath << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        if (!json)
+        {
+            std::cerr << "Unable to open file " << jsonPath << std::endl;
+            return EXIT_FAILURE;
+        }
+        printJson(results, warmup, reps, json);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,394 @@
+//
+// Created by michael on 19/10/2026.
+//
+// head to head run of the recommender implementations behind RecommenderEngine: the reference
+// RecommenderSystem and hadar::RecommenderSystem. every engine loads the same files and answers
+// the same instruction stream (the format of test_instructions_big.txt); the report gives, per
+// engine, the load time, the heap the loaded data holds, the query throughput, and how many
+// answers agree with the first engine's (names exactly, predictions within a tolerance), with
+// the first disagreements listed for debugging.
+//
+// usage: engine_compare [--dir <data dir>] [--reps n] [--tolerance t] [--show n]
+//                       [<name> <movies file> <ranks file> <instructions file>]...
+// with no datasets given, runs small and big from the data dir.
+//
+
+#include "RecommenderSystem.h"
+#include "hadar/hadar.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+
+#define DEFAULT_REPS 1
+#define DEFAULT_TOLERANCE 1e-6
+#define DEFAULT_SHOW 5
+#define BY_CONTENT "by_content"
+#define PREDICT "predicc"
+#define BY_CF "best_predicc"
+#define TYPES_NUM 3
+
+typedef std::chrono::steady_clock benchClock;
+
+/**
+ * the input files of a dataset
+ */
+struct Dataset
+{
+    std::string name;
+    std::string movies;
+    std::string ranks;
+    std::string instructions;
+};
+
+/**
+ * one line of the instructions file
+ */
+struct Instruction
+{
+    int type; // index in TYPE_NAMES
+    std::string movie;
+    std::string client;
+    int k;
+};
+
+/**
+ * the answer to an instruction, a movie name or a prediction
+ */
+struct Answer
+{
+    std::string name;
+    double prediction;
+};
+
+/**
+ * what one engine did with a dataset
+ */
+struct EngineResult
+{
+    std::string engine;
+    bool loaded;
+    double loadMillis;
+    double heapBytes; // the heap held after loading, beyond what was held before it
+    double queriesPerSecond;
+    std::vector<Answer> answers;
+};
+
+const char *const TYPE_NAMES[] = {BY_CONTENT, PREDICT, BY_CF};
+
+/**
+ * the implementations, in report order, the first is the one the others are compared to
+ */
+const std::vector<std::function<std::unique_ptr<RecommenderEngine>()> > ENGINES = {
+        []() { return std::unique_ptr<RecommenderEngine>(new RecommenderSystem()); },
+        []() { return std::unique_ptr<RecommenderEngine>(new hadar::RecommenderSystem()); }};
+
+/**
+ * reads the instructions file
+ * @param path
+ * @param out output, the instructions in file order
+ * @return true upon success
+ */
+bool readInstructions(const std::string &path, std::vector<Instruction> &out)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string type;
+        Instruction cur = {-1, "", "", 0};
+        if (!(lineStream >> type))
+        {
+            continue;
+        }
+        for (int t = 0; t < TYPES_NUM; t++)
+        {
+            cur.type = (type == TYPE_NAMES[t]) ? t : cur.type;
+        }
+        if (cur.type == -1)
+        {
+            return false;
+        }
+        if (type == PREDICT)
+        {
+            lineStream >> cur.movie;
+        }
+        lineStream >> cur.client >> cur.k;
+        out.push_back(cur);
+    }
+    return true;
+}
+
+/**
+ * @return the bytes the allocator currently hands out
+ */
+double heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (double) (info.uordblks + info.hblkhd); // the small chunks and the mapped ones
+#else
+    return 0.0; // not measured
+#endif
+}
+
+/**
+ * answers one instruction
+ * @param engine
+ * @param instruction
+ * @return the answer
+ */
+Answer answer(RecommenderEngine &engine, const Instruction &instruction)
+{
+    Answer out = {"", 0.0};
+    if (instruction.type == 0)
+    {
+        out.name = engine.recommendByContent(instruction.client);
+    }
+    else if (instruction.type == 1)
+    {
+        out.prediction = engine.predictMovieScoreForUser(instruction.movie, instruction.client,
+                                                         instruction.k);
+    }
+    else
+    {
+        out.name = engine.recommendByCF(instruction.client, instruction.k);
+    }
+    return out;
+}
+
+/**
+ * loads a dataset into a fresh engine and answers its instructions
+ * @param make creates the engine
+ * @param dataset
+ * @param instructions
+ * @param reps times the instructions are answered, the first answers are kept
+ * @return the result
+ */
+EngineResult runEngine(const std::function<std::unique_ptr<RecommenderEngine>()> &make,
+                       const Dataset &dataset, const std::vector<Instruction> &instructions,
+                       int reps)
+{
+    double heapBefore = heapInUse();
+    std::unique_ptr<RecommenderEngine> engine = make();
+    EngineResult result = {engine->engineName(), false, 0.0, 0.0, 0.0, {}};
+    benchClock::time_point start = benchClock::now();
+    result.loaded = engine->loadData(dataset.movies, dataset.ranks) == 0;
+    result.loadMillis = std::chrono::duration<double, std::milli>(benchClock::now() -
+                                                                  start).count();
+    result.heapBytes = heapInUse() - heapBefore;
+    if (!result.loaded)
+    {
+        return result;
+    }
+    start = benchClock::now();
+    for (int rep = 0; rep < reps; rep++)
+    {
+        for (const Instruction &instruction : instructions)
+        {
+            Answer cur = answer(*engine, instruction);
+            if (rep == 0)
+            {
+                result.answers.push_back(cur);
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(benchClock::now() - start).count();
+    result.queriesPerSecond = (seconds == 0.0) ? 0.0 : instructions.size() * reps / seconds;
+    return result;
+}
+
+/**
+ * @param lhs
+ * @param rhs
+ * @param type the instruction type they answer
+ * @param tolerance
+ * @return true if the answers agree
+ */
+bool agree(const Answer &lhs, const Answer &rhs, int type, double tolerance)
+{
+    if (type != 1)
+    {
+        return lhs.name == rhs.name;
+    }
+    double scale = std::max(1.0, std::max(std::abs(lhs.prediction), std::abs(rhs.prediction)));
+    return std::abs(lhs.prediction - rhs.prediction) <= tolerance * scale ||
+           (std::isnan(lhs.prediction) && std::isnan(rhs.prediction));
+}
+
+/**
+ * writes an instruction as its line in the instructions file
+ * @param out
+ * @param instruction
+ */
+void printInstruction(std::ostream &out, const Instruction &instruction)
+{
+    out << TYPE_NAMES[instruction.type];
+    if (instruction.type == 1)
+    {
+        out << " " << instruction.movie;
+    }
+    out << " " << instruction.client;
+    if (instruction.type != 0)
+    {
+        out << " " << instruction.k;
+    }
+}
+
+/**
+ * runs every engine on a dataset and prints the comparison
+ * @param dataset
+ * @param reps
+ * @param tolerance
+ * @param show the most disagreements listed per engine
+ * @return true if every engine loaded the dataset
+ */
+bool compareDataset(const Dataset &dataset, int reps, double tolerance, int show)
+{
+    std::vector<Instruction> instructions;
+    if (!readInstructions(dataset.instructions, instructions))
+    {
+        std::cerr << "Unable to read " << dataset.instructions << std::endl;
+        return false;
+    }
+    std::vector<EngineResult> results;
+    for (const auto &make : ENGINES)
+    {
+        results.push_back(runEngine(make, dataset, instructions, reps));
+    }
+    std::cout << dataset.name << " (" << instructions.size() << " instructions):" << std::endl;
+    bool loaded = true;
+    for (const EngineResult &result : results)
+    {
+        if (!result.loaded)
+        {
+            std::cout << "  " << result.engine << ": unable to load" << std::endl;
+            loaded = false;
+            continue;
+        }
+        std::cout << "  " << result.engine << ": load " << result.loadMillis << " ms, heap "
+                  << result.heapBytes / (1 << 20) << " MB, " << result.queriesPerSecond
+                  << " queries/s";
+        if (&result == &results[0] || !results[0].loaded)
+        {
+            std::cout << std::endl;
+            continue;
+        }
+        int agreed[TYPES_NUM] = {0};
+        int total[TYPES_NUM] = {0};
+        std::vector<size_t> differ;
+        for (size_t i = 0; i < instructions.size(); i++)
+        {
+            int type = instructions[i].type;
+            total[type]++;
+            if (agree(results[0].answers[i], result.answers[i], type, tolerance))
+            {
+                agreed[type]++;
+            }
+            else
+            {
+                differ.push_back(i);
+            }
+        }
+        std::cout << ", agrees with " << results[0].engine << " on";
+        for (int t = 0; t < TYPES_NUM; t++)
+        {
+            std::cout << " " << TYPE_NAMES[t] << " " << agreed[t] << "/" << total[t];
+        }
+        std::cout << std::endl;
+        for (size_t d = 0; d < differ.size() && d < (size_t) show; d++)
+        {
+            const Instruction &instruction = instructions[differ[d]];
+            std::cout << "    line " << differ[d] + 1 << ", ";
+            printInstruction(std::cout, instruction);
+            std::cout << ": ";
+            for (const EngineResult *cur : {(const EngineResult *) &results[0], &result})
+            {
+                const Answer &ans = cur->answers[differ[d]];
+                std::cout << cur->engine << " ";
+                if (instruction.type == 1)
+                {
+                    std::cout << ans.prediction;
+                }
+                else
+                {
+                    std::cout << ans.name;
+                }
+                std::cout << (cur == &result ? "" : ", ");
+            }
+            std::cout << std::endl;
+        }
+    }
+    return loaded;
+}
+
+/**
+ * runs the comparison
+ * @param argc
+ * @param argv
+ * @return EXIT_SUCCESS if every engine loaded every dataset
+ */
+int main(int argc, char **argv)
+{
+    std::string dir = ".";
+    int reps = DEFAULT_REPS;
+    double tolerance = DEFAULT_TOLERANCE;
+    int show = DEFAULT_SHOW;
+    std::vector<Dataset> datasets;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--dir") && hasValue)
+        {
+            dir = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--reps") && hasValue)
+        {
+            reps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (!std::strcmp(argv[i], "--tolerance") && hasValue)
+        {
+            tolerance = std::atof(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--show") && hasValue)
+        {
+            show = std::atoi(argv[++i]);
+        }
+        else if (argv[i][0] != '-' && i + 3 < argc)
+        {
+            datasets.push_back({argv[i], argv[i + 1], argv[i + 2], argv[i + 3]});
+            i += 3;
+        }
+        else
+        {
+            std::cerr << "Usage: engine_compare [--dir <data dir>] [--reps n] [--tolerance t] "
+                         "[--show n] [<name> <movies file> <ranks file> <instructions file>]..."
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (datasets.empty())
+    {
+        datasets.push_back({"small", dir + "/movies_small.txt", dir + "/ranks_small.txt",
+                            dir + "/test_instructions_small.txt"});
+        datasets.push_back({"big", dir + "/movies_big.txt", dir + "/ranks_big.txt",
+                            dir + "/test_instructions_big.txt"});
+    }
+    bool loaded = true;
+    for (const Dataset &dataset : datasets)
+    {
+        loaded = compareDataset(dataset, reps, tolerance, show) && loaded;
+    }
+    return loaded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
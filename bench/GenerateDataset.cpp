@@ -0,0 +1,484 @@
+//
+// Created by michael on 19/10/2026.
+//
+// synthetic dataset generator for scaling tests. writes a movie attributes file, a ranks file, a
+// binary snapshot of both (see Snapshot.h, loaded by RecommenderSystem::loadSnapshot) and an
+// instruction file in the format of test_instructions_big.txt, every query of which is valid for
+// the generated data.
+//
+// movies get uniform attributes in 1..10, a hidden quality, and a popularity that follows a zipf
+// law over a shuffled order. every client ranks about density * movies movies, picked by
+// popularity without repetition, and ranks them by the movie's quality, the client's bias, the
+// agreement of the movie's attributes with the client's hidden taste, and noise, rounded to
+// 1..10. each client draws from its own stream seeded by the seed and its index, so the output
+// depends only on the parameters, and a smaller --users gives a prefix of a larger one.
+//
+// usage: dataset_generator [--seed s] [--users n] [--movies n] [--dims n] [--density d]
+//                          [--zipf s] [--queries n] [--format text|snapshot|both] [--out <dir>]
+// e.g. dataset_generator --users 100000 --movies 2000 --density 0.02 --out /tmp/scale
+// writes movies.txt, ranks.txt, snapshot.bin and instructions.txt to the out dir.
+//
+
+#include "Snapshot.h"
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#define DEFAULT_SEED 1
+#define DEFAULT_USERS 1000
+#define DEFAULT_MOVIES 750
+#define DEFAULT_DIMS 20
+#define DEFAULT_DENSITY 0.1
+#define DEFAULT_ZIPF 1.0
+#define DEFAULT_QUERIES 100
+#define MIN_RANK 1
+#define MAX_RANK 10
+#define MAX_K 10 // the largest k of a generated query, capped by what the client ranked
+#define QUALITY_WEIGHT 1.5
+#define TASTE_WEIGHT 2.0
+#define NOISE_WEIGHT 1.0
+#define QUERY_TYPES 3
+#define SPARSE_RATIO 4 // clients ranking at most a quarter of the movies are drawn sparsely
+#define DRAW_BUDGET 8 // draws per ranked movie before the sparse drawing gives up
+#define QUERY_STREAM 0x9e3779b97f4a7c15ULL // keeps the query stream apart from the clients'
+
+/**
+ * the generator's parameters
+ */
+struct Parameters
+{
+    uint64_t seed = DEFAULT_SEED;
+    size_t users = DEFAULT_USERS;
+    size_t movies = DEFAULT_MOVIES;
+    size_t dims = DEFAULT_DIMS;
+    double density = DEFAULT_DENSITY;
+    double zipf = DEFAULT_ZIPF;
+    size_t queries = DEFAULT_QUERIES;
+    bool text = true;
+    bool snapshot = true;
+    std::string out = ".";
+};
+
+/**
+ * a random stream. the engine's output is fixed by the standard, and the distributions are
+ * derived here rather than taken from <random>, whose results differ between libraries
+ */
+class Stream
+{
+private:
+    std::mt19937_64 _engine;
+public:
+    /**
+     * @param seed
+     */
+    explicit Stream(uint64_t seed)
+    {
+        // splitmix64 finalizer, so neighboring seeds give unrelated streams
+        seed += 0x9e3779b97f4a7c15ULL;
+        seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+        _engine.seed(seed ^ (seed >> 31));
+    }
+    /**
+     * @return uniform in (0, 1)
+     */
+    double uniform()
+    {
+        return ((double) (_engine() >> 11) + 0.5) / 9007199254740992.0;
+    }
+    /**
+     * @param n
+     * @return uniform in 0..n - 1
+     */
+    size_t below(size_t n)
+    {
+        return (size_t) (uniform() * n);
+    }
+    /**
+     * @return standard normal, by the box muller transform
+     */
+    double normal()
+    {
+        return std::sqrt(-2.0 * std::log(uniform())) * std::cos(2.0 * M_PI * uniform());
+    }
+};
+
+/**
+ * the hidden and visible properties of the movies
+ */
+struct Catalog
+{
+    std::vector<std::string> names;
+    std::vector<std::vector<double> > attributes;
+    std::vector<double> centered; // the attributes minus the middle rank, movie after movie
+    std::vector<double> quality;
+    std::vector<double> popularity; // the zipf weight of each movie
+    std::vector<size_t> byPopularity; // the movies from the most popular to the least
+    std::vector<double> cumulative; // the running sum of the weights in that order
+};
+
+/**
+ * a query of the instruction file
+ */
+struct Query
+{
+    size_t user;
+    int type; // 0 by_content, 1 predicc, 2 best_predicc
+    std::string line; // filled when the user is generated
+};
+
+/**
+ * draws the movies
+ * @param params
+ * @return the catalog
+ */
+Catalog makeCatalog(const Parameters &params)
+{
+    Stream stream(params.seed);
+    Catalog catalog;
+    catalog.attributes.assign(params.movies, std::vector<double>(params.dims));
+    catalog.centered.resize(params.movies * params.dims);
+    catalog.quality.resize(params.movies);
+    catalog.popularity.resize(params.movies);
+    std::vector<size_t> order(params.movies);
+    for (size_t i = 0; i < params.movies; i++)
+    {
+        catalog.names.push_back("Movie" + std::to_string(i));
+        order[i] = i;
+    }
+    for (size_t i = params.movies; i > 1; i--)
+    { // fisher yates, so popularity is unrelated to the index
+        std::swap(order[i - 1], order[stream.below(i)]);
+    }
+    double middle = (MIN_RANK + MAX_RANK) / 2.0;
+    for (size_t i = 0; i < params.movies; i++)
+    {
+        for (size_t d = 0; d < params.dims; d++)
+        {
+            double val = MIN_RANK + (double) stream.below(MAX_RANK - MIN_RANK + 1);
+            catalog.attributes[i][d] = val;
+            catalog.centered[i * params.dims + d] = val - middle;
+        }
+        catalog.quality[i] = stream.normal();
+        catalog.popularity[order[i]] = std::pow((double) (i + 1), -params.zipf);
+    }
+    catalog.byPopularity = order;
+    double sum = 0.0;
+    for (size_t movie : order)
+    {
+        sum += catalog.popularity[movie];
+        catalog.cumulative.push_back(sum);
+    }
+    return catalog;
+}
+
+/**
+ * draws the ranks of one client
+ * @param params
+ * @param catalog
+ * @param user the client's index
+ * @param ranks output, the client's rank of every movie, 0.0 means not ranked
+ * @param keys scratch of the movies' count
+ * @param picked scratch, the ranked movies
+ * @return the number of movies ranked
+ */
+size_t makeRanks(const Parameters &params, const Catalog &catalog, size_t user,
+                 std::vector<double> &ranks, std::vector<std::pair<double, size_t> > &keys,
+                 std::vector<size_t> &picked)
+{
+    Stream stream(params.seed * 0x100000001b3ULL + user + 1);
+    std::vector<double> taste(params.dims);
+    double tasteNorm = 0.0;
+    for (double &val : taste)
+    {
+        val = stream.normal();
+        tasteNorm += val * val;
+    }
+    tasteNorm = std::sqrt(tasteNorm);
+    double bias = stream.normal();
+    double expected = params.density * params.movies * (0.5 + stream.uniform());
+    size_t count = std::min(params.movies, (size_t) std::max(1.0, std::round(expected)));
+    picked.clear();
+    ranks.assign(params.movies, 0.0);
+    // sparse clients draw by popularity and skip repeats, which stays cheap while the repeats
+    // are rare; past a budget of draws the exact method below takes over
+    for (size_t draws = 0; count * SPARSE_RATIO <= params.movies && picked.size() < count &&
+                           draws < count * DRAW_BUDGET; draws++)
+    {
+        double target = stream.uniform() * catalog.cumulative.back();
+        size_t place = std::upper_bound(catalog.cumulative.begin(), catalog.cumulative.end(),
+                                        target) - catalog.cumulative.begin();
+        size_t movie = catalog.byPopularity[std::min(place, params.movies - 1)];
+        if (ranks[movie] == 0.0)
+        {
+            ranks[movie] = MAX_RANK;
+            picked.push_back(movie);
+        }
+    }
+    if (picked.size() < count)
+    { // weighted sampling without repetition: the count smallest exponential keys scaled down
+        // by the weights (efraimidis and spirakis)
+        for (size_t i = 0; i < params.movies; i++)
+        {
+            keys[i] = std::make_pair(-std::log(stream.uniform()) / catalog.popularity[i], i);
+        }
+        std::nth_element(keys.begin(), keys.begin() + (count - 1), keys.end());
+        picked.clear();
+        ranks.assign(params.movies, 0.0);
+        for (size_t p = 0; p < count; p++)
+        {
+            picked.push_back(keys[p].second);
+        }
+    }
+    for (size_t movie : picked)
+    {
+        const double *attributes = &catalog.centered[movie * params.dims];
+        double dot = 0.0;
+        double norm = 0.0;
+        for (size_t d = 0; d < params.dims; d++)
+        {
+            dot += attributes[d] * taste[d];
+            norm += attributes[d] * attributes[d];
+        }
+        double agreement = (norm == 0.0 || tasteNorm == 0.0) ? 0.0
+                                                            : dot / std::sqrt(norm) / tasteNorm;
+        double score = (MIN_RANK + MAX_RANK) / 2.0 + QUALITY_WEIGHT * catalog.quality[movie] +
+                       bias + TASTE_WEIGHT * agreement + NOISE_WEIGHT * stream.normal();
+        ranks[movie] = std::min((double) MAX_RANK, std::max((double) MIN_RANK,
+                                                              std::round(score)));
+    }
+    return count;
+}
+
+/**
+ * writes the instruction line of a query
+ * @param params
+ * @param catalog
+ * @param name the client's name
+ * @param ranks the client's ranks
+ * @param count the number of movies ranked
+ * @param query the query, its line is filled
+ */
+void makeQuery(const Parameters &params, const Catalog &catalog, const std::string &name,
+               const std::vector<double> &ranks, size_t count, Query &query)
+{
+    Stream stream(params.seed ^ QUERY_STREAM ^ (query.user * 0x100000001b3ULL));
+    int k = 1 + (int) stream.below(std::min((size_t) MAX_K, count));
+    if (query.type == 1 && count < params.movies)
+    {
+        size_t unranked = stream.below(params.movies - count);
+        size_t movie = 0;
+        for (; ranks[movie] != 0.0 || unranked != 0; movie++)
+        {
+            unranked -= (ranks[movie] == 0.0);
+        }
+        query.line = "predicc " + catalog.names[movie] + " " + name + " " + std::to_string(k);
+    }
+    else if (query.type == 2)
+    {
+        query.line = "best_predicc " + name + " " + std::to_string(k);
+    }
+    else
+    {
+        query.line = "by_content " + name;
+    }
+}
+
+/**
+ * appends a rank vector to a ranks file line
+ * @param line
+ * @param ranks
+ */
+void appendRanks(std::string &line, const std::vector<double> &ranks)
+{
+    for (double rank : ranks)
+    {
+        line += ' ';
+        line += (rank == 0.0) ? "NA" : std::to_string((int) rank);
+    }
+    line += '\n';
+}
+
+/**
+ * parses the command line
+ * @param argc
+ * @param argv
+ * @param params output
+ * @return true upon valid arguments
+ */
+bool parseArguments(int argc, char **argv, Parameters &params)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            return false;
+        }
+        const char *value = argv[i + 1];
+        if (!std::strcmp(argv[i], "--seed"))
+        {
+            params.seed = std::strtoull(value, nullptr, 10);
+        }
+        else if (!std::strcmp(argv[i], "--users"))
+        {
+            params.users = std::strtoull(value, nullptr, 10);
+        }
+        else if (!std::strcmp(argv[i], "--movies"))
+        {
+            params.movies = std::strtoull(value, nullptr, 10);
+        }
+        else if (!std::strcmp(argv[i], "--dims"))
+        {
+            params.dims = std::strtoull(value, nullptr, 10);
+        }
+        else if (!std::strcmp(argv[i], "--density"))
+        {
+            params.density = std::atof(value);
+        }
+        else if (!std::strcmp(argv[i], "--zipf"))
+        {
+            params.zipf = std::atof(value);
+        }
+        else if (!std::strcmp(argv[i], "--queries"))
+        {
+            params.queries = std::strtoull(value, nullptr, 10);
+        }
+        else if (!std::strcmp(argv[i], "--format"))
+        {
+            params.text = std::strcmp(value, "snapshot") != 0;
+            params.snapshot = std::strcmp(value, "text") != 0;
+            if (!params.text && !params.snapshot)
+            {
+                return false;
+            }
+        }
+        else if (!std::strcmp(argv[i], "--out"))
+        {
+            params.out = value;
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+    return params.users > 0 && params.movies > 0 && params.dims > 0 && params.density > 0.0 &&
+           params.density <= 1.0 && params.zipf >= 0.0 && params.movies <= UINT32_MAX;
+}
+
+/**
+ * generates the dataset
+ * @param argc
+ * @param argv
+ * @return EXIT_SUCCESS upon success
+ */
+int main(int argc, char **argv)
+{
+    Parameters params;
+    if (!parseArguments(argc, argv, params))
+    {
+        std::cerr << "Usage: dataset_generator [--seed s] [--users n] [--movies n] [--dims n] "
+                     "[--density d] [--zipf s] [--queries n] [--format text|snapshot|both] "
+                     "[--out <dir>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    Catalog catalog = makeCatalog(params);
+    Stream queryStream(params.seed ^ QUERY_STREAM);
+    std::vector<Query> queries(params.queries);
+    std::vector<size_t> byUser(params.queries);
+    for (size_t q = 0; q < params.queries; q++)
+    {
+        queries[q].user = queryStream.below(params.users);
+        queries[q].type = (int) queryStream.below(QUERY_TYPES);
+        byUser[q] = q;
+    }
+    std::sort(byUser.begin(), byUser.end(), [&queries](size_t lhs, size_t rhs)
+    {
+        return queries[lhs].user < queries[rhs].user;
+    });
+
+    std::ofstream moviesFile;
+    std::ofstream ranksFile;
+    SnapshotWriter snapshot;
+    std::vector<const std::vector<double> *> attributeRows;
+    for (const std::vector<double> &row : catalog.attributes)
+    {
+        attributeRows.push_back(&row);
+    }
+    if (params.text)
+    {
+        moviesFile.open(params.out + "/movies.txt");
+        ranksFile.open(params.out + "/ranks.txt");
+        std::string line;
+        for (size_t i = 0; i < params.movies; i++)
+        {
+            line = catalog.names[i];
+            for (double val : catalog.attributes[i])
+            {
+                line += ' ' + std::to_string((int) val);
+            }
+            moviesFile << line << '\n';
+            ranksFile << (i ? " " : "") << catalog.names[i];
+        }
+        ranksFile << '\n';
+    }
+    if ((params.text && (!moviesFile || !ranksFile)) ||
+        (params.snapshot &&
+         snapshot.open(params.out + "/snapshot.bin", catalog.names, attributeRows) != 0))
+    {
+        std::cerr << "Unable to write to " << params.out << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<double> ranks;
+    std::vector<std::pair<double, size_t> > keys(params.movies);
+    std::vector<size_t> picked;
+    std::string line;
+    size_t nextQuery = 0;
+    size_t totalRanks = 0;
+    for (size_t user = 0; user < params.users; user++)
+    {
+        std::string name = "User" + std::to_string(user);
+        size_t count = makeRanks(params, catalog, user, ranks, keys, picked);
+        totalRanks += count;
+        for (; nextQuery < byUser.size() && queries[byUser[nextQuery]].user == user; nextQuery++)
+        {
+            makeQuery(params, catalog, name, ranks, count, queries[byUser[nextQuery]]);
+        }
+        if (params.text)
+        {
+            line = name;
+            appendRanks(line, ranks);
+            ranksFile << line;
+        }
+        if (params.snapshot && snapshot.addClient(name, ranks) != 0)
+        {
+            std::cerr << "Unable to write to " << params.out << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ofstream instructions(params.out + "/instructions.txt");
+    for (const Query &query : queries)
+    {
+        instructions << query.line << '\n';
+    }
+    ranksFile.close();
+    if (!instructions || (params.text && !ranksFile) ||
+        (params.snapshot && snapshot.close() != 0))
+    {
+        std::cerr << "Unable to write to " << params.out << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << params.users << " clients, " << params.movies << " movies, " << params.dims
+              << " attributes, " << totalRanks << " ranks ("
+              << (double) totalRanks / ((double) params.users * params.movies) << " density), "
+              << params.queries << " queries" << std::endl;
+    return EXIT_SUCCESS;
+}
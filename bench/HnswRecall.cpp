@@ -0,0 +1,103 @@
+//
+// Created by michael on 19/10/2026.
+//
+// measures the recall and latency of recommendByContentApprox against the exact
+// recommendByContent, for every client in the ranks file and a range of ef values.
+//
+// usage: hnsw_recall <movies file> <ranks file> [m] [efConstruction]
+// e.g. hnsw_recall movies_big.txt ranks_big.txt 16 200
+//
+
+#include "RecommenderSystem.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+
+#define DEFAULT_M 16
+#define DEFAULT_EF_CONSTRUCTION 200
+#define MAX_EF 256
+
+typedef std::chrono::steady_clock benchClock;
+
+/**
+ * reads the client names out of a ranks file
+ * @param path
+ * @return the names in file order
+ */
+std::vector<std::string> readClients(const std::string &path)
+{
+    std::vector<std::string> clients;
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line); // the movie names
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string name;
+        if (lineStream >> name)
+        {
+            clients.push_back(name);
+        }
+    }
+    return clients;
+}
+
+/**
+ * @param start
+ * @return the microseconds passed since start
+ */
+double microsSince(benchClock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(benchClock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: hnsw_recall <movies file> <ranks file> [m] [efConstruction]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    int m = (argc > 3) ? std::atoi(argv[3]) : DEFAULT_M;
+    int efConstruction = (argc > 4) ? std::atoi(argv[4]) : DEFAULT_EF_CONSTRUCTION;
+    RecommenderSystem rs;
+    if (rs.loadData(argv[1], argv[2]) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> clients = readClients(argv[2]);
+
+    benchClock::time_point start = benchClock::now();
+    std::vector<std::string> exact;
+    for (const std::string &client : clients)
+    {
+        exact.push_back(rs.recommendByContent(client));
+    }
+    double exactMicros = microsSince(start) / clients.size();
+
+    start = benchClock::now();
+    if (rs.buildContentIndex(m, efConstruction) != 0)
+    {
+        std::cerr << "Invalid index parameters" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "index build (m = " << m << ", efConstruction = " << efConstruction << "): "
+              << microsSince(start) / 1000.0 << " ms" << std::endl;
+    std::cout << "exact scan: " << exactMicros << " us/query" << std::endl;
+    std::cout << "ef\trecall@1\tus/query" << std::endl;
+    for (int ef = 1; ef <= MAX_EF; ef *= 2)
+    {
+        rs.setContentIndexEf(ef);
+        size_t hits = 0;
+        start = benchClock::now();
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            hits += (rs.recommendByContentApprox(clients[i]) == exact[i]);
+        }
+        double micros = microsSince(start) / clients.size();
+        std::cout << ef << "\t" << (double) hits / clients.size() << "\t" << micros << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
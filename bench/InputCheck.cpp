@@ -0,0 +1,224 @@
+//
+// Created by michael on 19/10/2026.
+//
+// loads small hand written inputs that the queries once mishandled, and checks the answers the
+// recommender gives for them. every case writes its movies and ranks files to the given
+// directory, loads them and compares the answers of a few queries with the expected ones.
+// exits with a failure if any answer differs.
+//
+// usage: input_check [dir]
+// e.g. input_check /tmp
+//
+
+#include "RecommenderSystem.h"
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#define DEFAULT_DIR "."
+#define NO_CLIENT "USER NOT FOUND"
+#define HEADER_OFFSET 8 // the bytes of the snapshot's magic, before the movies and attributes counts
+#define HUGE_COUNT (1ULL << 40)
+
+std::string snapshotPath; // where the snapshot cases write, set by main
+
+/**
+ * one input and the answers expected for it
+ */
+struct Case
+{
+    const char *name;
+    const char *movies; // the movies file
+    const char *ranks; // the ranks file
+    /**
+     * @param rs the recommender, loaded with the case files
+     * @param loaded the return value of loadData
+     * @return the description of the first wrong answer, empty if all are right
+     */
+    std::string (*check)(RecommenderSystem &rs, int loaded);
+};
+
+/**
+ * @param what the query
+ * @param got its answer
+ * @param expected the right answer
+ * @return empty if got is expected, else the description of the wrong answer
+ */
+std::string expect(const std::string &what, const std::string &got, const std::string &expected)
+{
+    return (got == expected) ? std::string() :
+           what + " gave \"" + got + "\" instead of \"" + expected + "\"";
+}
+
+/**
+ * a client line with a name and no ranks: the client is not loaded, and must not be queried
+ * through an empty rank vector
+ */
+std::string checkNameOnlyClient(RecommenderSystem &rs, int loaded)
+{
+    std::string out = expect("loadData", std::to_string(loaded), "0");
+    out += expect("recommendByContent(bob)", rs.recommendByContent("bob"), NO_CLIENT);
+    out += expect("recommendByCF(bob)", rs.recommendByCF("bob", 1), NO_CLIENT);
+    out += expect("predictMovieScoreForUser(m2, bob)",
+                  std::to_string(rs.predictMovieScoreForUser("m2", "bob", 1)),
+                  std::to_string((double) NOT_EXSISTS));
+    out += expect("lookupUser(bob)", std::to_string(rs.lookupUser("bob").id),
+                  std::to_string(INVALID_HANDLE));
+    UserHandle bob = {1};
+    out += expect("recommendByContent(handle of bob)", rs.recommendByContent(bob), NO_CLIENT);
+    out += expect("recommendHybrid(bob)", rs.recommendHybrid("bob", 1, 0.5), NO_CLIENT);
+    out += expect("recommendByContentApprox(bob)", rs.recommendByContentApprox("bob"), NO_CLIENT);
+    out += expect("recommendByContentLsh(bob)", rs.recommendByContentLsh("bob", 2), NO_CLIENT);
+    out += expect("recommendByContentQuantized(bob)", rs.recommendByContentQuantized("bob"),
+                  NO_CLIENT);
+    out += expect("filtered recommendByCF(bob)",
+                  std::to_string(rs.recommendByCF("bob", 1, {}, 2).size()), "0");
+    out += expect("recommendByContent(alice)", rs.recommendByContent("alice"), "m2");
+    return out;
+}
+
+/**
+ * a movie file that does not fit the ranks: the load fails instead of leaving movies the
+ * queries would read attributes of that are not there
+ */
+std::string checkLoadFails(RecommenderSystem &, int loaded)
+{
+    return expect("loadData", std::to_string(loaded), "-1");
+}
+
+/**
+ * a dot product similarity far below -1: its best movie is still found
+ */
+std::string checkUnboundedSimilarity(RecommenderSystem &rs, int)
+{
+    std::string out = expect("recommendByContent(u)", rs.recommendByContent("u"), "m2");
+    out += expect("recommendByContent<DotProductSimilarity>(u)",
+                  rs.recommendByContent<DotProductSimilarity>("u"), "m2");
+    return out;
+}
+
+/**
+ * @param path
+ * @param bytes
+ * @return true upon success
+ */
+bool writeBytes(const std::string &path, const std::string &bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+    return (bool) file;
+}
+
+/**
+ * @param bytes a snapshot
+ * @param at the offset of a header count
+ * @param count the value to write over it
+ * @return the snapshot with the count replaced
+ */
+std::string withCount(std::string bytes, size_t at, uint64_t count)
+{
+    std::memcpy(&bytes[at], &count, sizeof(count));
+    return bytes;
+}
+
+/**
+ * a snapshot whose header counts more movies or attributes than the file holds, or that was cut
+ * short: the load fails instead of allocating by the corrupt counts
+ */
+std::string checkCorruptSnapshots(RecommenderSystem &rs, int)
+{
+    if (rs.saveSnapshot(snapshotPath) != 0)
+    {
+        return "saveSnapshot failed";
+    }
+    std::ifstream file(snapshotPath, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const std::pair<const char *, std::string> snapshots[] = {
+            {"huge movies count", withCount(bytes, HEADER_OFFSET, HUGE_COUNT)},
+            {"huge attributes count", withCount(bytes, HEADER_OFFSET + sizeof(uint64_t),
+                                                HUGE_COUNT)},
+            {"truncated movies", bytes.substr(0, bytes.size() / 4)},
+    };
+    std::string out;
+    for (const std::pair<const char *, std::string> &snapshot : snapshots)
+    {
+        RecommenderSystem loaded;
+        int status = writeBytes(snapshotPath, snapshot.second) ?
+                     loaded.loadSnapshot(snapshotPath) : 0;
+        out += expect(std::string("loadSnapshot of ") + snapshot.first, std::to_string(status),
+                      "-1");
+    }
+    RecommenderSystem intact;
+    int status = writeBytes(snapshotPath, bytes) ? intact.loadSnapshot(snapshotPath) : -1;
+    out += expect("loadSnapshot", std::to_string(status), "0");
+    std::remove(snapshotPath.c_str());
+    return out;
+}
+
+const Case CASES[] = {
+        {"client line without ranks",
+         "m1 1 2\nm2 2 1\nm3 1 1\n",
+         "m1 m2 m3\nalice 5 NA 3\nbob\n",
+         checkNameOnlyClient},
+        {"movie of the ranks without attributes",
+         "m1 1 2\nm2 2 1\n",
+         "m1 m2 m3\nalice 5 NA 3\n",
+         checkLoadFails},
+        {"movies with different numbers of attributes",
+         "m1 1 2\nm2 2\nm3 1 1\n",
+         "m1 m2 m3\nalice 5 NA 3\n",
+         checkLoadFails},
+        {"negative dot products",
+         "m1 10 10\nm2 10 10\nm3 1 1\n",
+         "m1 m2 m3\nu 1 NA 10\n",
+         checkUnboundedSimilarity},
+        {"corrupt snapshots",
+         "m1 1 2\nm2 2 1\nm3 1 1\n",
+         "m1 m2 m3\nalice 5 NA 3\ncarol NA 4 2\n",
+         checkCorruptSnapshots},
+};
+
+/**
+ * @param path
+ * @param content
+ * @return true upon success
+ */
+bool writeFile(const std::string &path, const char *content)
+{
+    std::ofstream file(path);
+    file << content;
+    return (bool) file;
+}
+
+int main(int argc, char **argv)
+{
+    std::string dir = (argc > 1) ? argv[1] : DEFAULT_DIR;
+    std::string moviesPath = dir + "/input_check_movies.txt";
+    std::string ranksPath = dir + "/input_check_ranks.txt";
+    snapshotPath = dir + "/input_check.snap";
+    int failed = 0;
+    for (const Case &input : CASES)
+    {
+        if (!writeFile(moviesPath, input.movies) || !writeFile(ranksPath, input.ranks))
+        {
+            std::cerr << "cannot write to " << dir << std::endl;
+            return EXIT_FAILURE;
+        }
+        RecommenderSystem rs;
+        int loaded = rs.loadData(moviesPath, ranksPath);
+        std::string wrong = input.check(rs, loaded);
+        std::cout << input.name << ": " << (wrong.empty() ? "ok" : wrong) << std::endl;
+        failed += !wrong.empty();
+    }
+    std::remove(moviesPath.c_str());
+    std::remove(ranksPath.c_str());
+    if (failed != 0)
+    {
+        std::cout << failed << " inputs answered wrong" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "all inputs answered right" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+//
+// Created by michael on 19/10/2026.
+//
+// runs an instructions file through the double algorithms and through the float model, and
+// reports how often they agree, the largest prediction error and the time of each. a
+// recommendation that differs only by picking another movie with the same score is counted as
+// tied.
+//
+// usage: precision_report <instructions file> <movies file> <ranks file>
+// e.g. precision_report test_instructions_big.txt movies_big.txt ranks_big.txt
+//
+// the instructions are the lines of the test files:
+//   by_content <client>
+//   predicc <movie> <client> <k>
+//   best_predicc <client> <k>
+//
+
+#include "RecommenderSystem.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#define CONTENT "by_content"
+#define PREDICT "predicc"
+#define CF "best_predicc"
+#define TOLERANCE 1e-4 // float keeps about 7 significant digits of a rank in [1, 10]
+
+typedef std::chrono::steady_clock benchClock;
+
+/**
+ * one line of the instructions file
+ */
+struct Instruction
+{
+    std::string type;
+    std::string movie;
+    std::string client;
+    int k;
+};
+
+/**
+ * reads the instructions file
+ * @param path
+ * @param out output, the instructions in file order
+ * @return true upon success
+ */
+bool readInstructions(const std::string &path, std::vector<Instruction> &out)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        Instruction cur = {"", "", "", 0};
+        if (!(lineStream >> cur.type))
+        {
+            continue;
+        }
+        if (cur.type == PREDICT)
+        {
+            lineStream >> cur.movie;
+        }
+        lineStream >> cur.client >> cur.k;
+        out.push_back(cur);
+    }
+    return true;
+}
+
+/**
+ * runs the instructions
+ * @param rs
+ * @param instructions
+ * @param useFloat true to run the float algorithms
+ * @param out output, the result of every instruction, a movie name or a prediction
+ * @param predictions output, the prediction of every predicc instruction, 0 for the others
+ * @return the seconds it took
+ */
+double run(RecommenderSystem &rs, const std::vector<Instruction> &instructions, bool useFloat,
+           std::vector<std::string> &out, std::vector<double> &predictions)
+{
+    benchClock::time_point start = benchClock::now();
+    for (const Instruction &cur : instructions)
+    {
+        double prediction = 0.0;
+        if (cur.type == CONTENT)
+        {
+            out.push_back(useFloat ? rs.recommendByContentFloat(cur.client)
+                                   : rs.recommendByContent(cur.client));
+        }
+        else if (cur.type == PREDICT)
+        {
+            prediction = useFloat ? rs.predictMovieScoreForUserFloat(cur.movie, cur.client, cur.k)
+                                  : rs.predictMovieScoreForUser(cur.movie, cur.client, cur.k);
+            out.push_back(std::to_string(prediction));
+        }
+        else
+        {
+            out.push_back(useFloat ? rs.recommendByCFFloat(cur.client, cur.k)
+                                   : rs.recommendByCF(cur.client, cur.k));
+        }
+        predictions.push_back(prediction);
+    }
+    return std::chrono::duration<double>(benchClock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: precision_report <instructions file> <movies file> <ranks file>"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<Instruction> instructions;
+    RecommenderSystem rs;
+    if (!readInstructions(argv[1], instructions) || rs.loadData(argv[2], argv[3]) != 0 ||
+        rs.buildFloatModel() != 0)
+    {
+        std::cerr << "Unable to load the data" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> exact;
+    std::vector<std::string> approx;
+    std::vector<double> exactPredictions;
+    std::vector<double> approxPredictions;
+    double doubleSeconds = run(rs, instructions, false, exact, exactPredictions);
+    double floatSeconds = run(rs, instructions, true, approx, approxPredictions);
+
+    size_t identical[3] = {0, 0, 0};
+    size_t equivalent[3] = {0, 0, 0};
+    size_t total[3] = {0, 0, 0};
+    double maxError = 0.0;
+    for (size_t i = 0; i < instructions.size(); i++)
+    {
+        const Instruction &cur = instructions[i];
+        size_t kind = (cur.type == CONTENT) ? 0 : (cur.type == PREDICT) ? 1 : 2;
+        total[kind]++;
+        identical[kind] += (exact[i] == approx[i]);
+        if (kind == 1)
+        {
+            double error = std::fabs(exactPredictions[i] - approxPredictions[i]);
+            maxError = std::max(maxError, error);
+            equivalent[kind] += (error <= TOLERANCE);
+        }
+        else if (kind == 2 && exact[i] != approx[i])
+        { // a different movie with the same double prediction is a tie, not an error
+            double best = rs.predictMovieScoreForUser(exact[i], cur.client, cur.k);
+            double picked = rs.predictMovieScoreForUser(approx[i], cur.client, cur.k);
+            equivalent[kind] += (std::fabs(best - picked) <= TOLERANCE);
+        }
+    }
+    equivalent[0] += identical[0];
+    equivalent[2] += identical[2];
+    std::cout << "instructions: " << instructions.size() << std::endl;
+    std::cout << "recommendByContent: " << identical[0] << " / " << total[0] << " identical, "
+              << equivalent[0] << " identical or tied" << std::endl;
+    std::cout << "predictMovieScoreForUser: " << identical[1] << " / " << total[1]
+              << " identical to 6 digits, " << equivalent[1] << " within " << TOLERANCE
+              << ", max error " << maxError << std::endl;
+    std::cout << "recommendByCF: " << identical[2] << " / " << total[2] << " identical, "
+              << equivalent[2] << " identical or tied" << std::endl;
+    std::cout << "time: " << doubleSeconds * 1000.0 << " ms double, " << floatSeconds * 1000.0
+              << " ms float" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+//
+// Created by michael on 19/10/2026.
+//
+// reports the accuracy of the 8 bit attribute path against the double path: the error of the
+// movie to movie cosines, the agreement of the content recommendations, and the agreement of
+// the cf predictions when the neighbor lists are built with the 8 bit kernels.
+//
+// usage: quantization_report <movies file> <ranks file> [k] [m]
+// e.g. quantization_report movies_big.txt ranks_big.txt 5 50
+//
+
+#include "RecommenderSystem.h"
+#include "QuantizedAttributes.h"
+#include "VectorMath.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#define DEFAULT_K 5
+#define DEFAULT_M 50
+#define PREDICTED_MOVIES 20
+
+typedef std::chrono::steady_clock benchClock;
+
+/**
+ * reads the names out of the first column of a file
+ * @param path
+ * @param skipHeader true for a ranks file, whose first line holds the movie names
+ * @return the names in file order
+ */
+std::vector<std::string> readNames(const std::string &path, bool skipHeader)
+{
+    std::vector<std::string> names;
+    std::ifstream file(path);
+    std::string line;
+    if (skipHeader)
+    {
+        std::getline(file, line);
+    }
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string name;
+        if (lineStream >> name)
+        {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+/**
+ * reads the movie attribute vectors, in the order of the movie names in the ranks file
+ * @param moviesPath
+ * @param ranksPath
+ * @return the vectors
+ */
+std::vector<std::vector<double> > readAttributes(const std::string &moviesPath,
+                                                 const std::string &ranksPath)
+{
+    std::map<std::string, std::vector<double> > movies;
+    std::ifstream file(moviesPath);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string name;
+        double val;
+        lineStream >> name;
+        while (lineStream >> val)
+        {
+            movies[name].push_back(val);
+        }
+    }
+    std::ifstream ranks(ranksPath);
+    std::getline(ranks, line);
+    std::istringstream header(line);
+    std::vector<std::vector<double> > out;
+    std::string name;
+    while (header >> name)
+    {
+        out.push_back(movies[name]);
+    }
+    return out;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: quantization_report <movies file> <ranks file> [k] [m]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    int k = (argc > 3) ? std::atoi(argv[3]) : DEFAULT_K;
+    int m = (argc > 4) ? std::atoi(argv[4]) : DEFAULT_M;
+    std::vector<std::vector<double> > attributes = readAttributes(argv[1], argv[2]);
+    std::vector<const std::vector<double> *> rows;
+    for (const std::vector<double> &vec : attributes)
+    {
+        rows.push_back(&vec);
+    }
+    QuantizedAttributes quantized;
+    if (attributes.empty() || quantized.build(rows) != 0)
+    {
+        std::cerr << "Attributes must be loaded and not negative" << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t dims = attributes[0].size();
+
+    // movie to movie cosines
+    double maxError = 0.0;
+    double sumError = 0.0;
+    double checksum = 0.0;
+    size_t pairs = 0;
+    benchClock::time_point start = benchClock::now();
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        for (size_t j = i; j < rows.size(); j++)
+        {
+            checksum += quantized.cosine(i, j);
+        }
+    }
+    double int8Seconds = std::chrono::duration<double>(benchClock::now() - start).count();
+    start = benchClock::now();
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        for (size_t j = i; j < rows.size(); j++)
+        {
+            checksum += VectorMath::exactDotProd(rows[i]->data(), rows[j]->data(), dims) /
+                        (VectorMath::exactNorm(rows[i]->data(), dims) *
+                         VectorMath::exactNorm(rows[j]->data(), dims));
+        }
+    }
+    double doubleSeconds = std::chrono::duration<double>(benchClock::now() - start).count();
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        for (size_t j = i; j < rows.size(); j++)
+        {
+            double exact = VectorMath::exactDotProd(rows[i]->data(), rows[j]->data(), dims) /
+                           (VectorMath::exactNorm(rows[i]->data(), dims) *
+                            VectorMath::exactNorm(rows[j]->data(), dims));
+            double error = std::fabs(quantized.cosine(i, j) - exact);
+            maxError = std::max(maxError, error);
+            sumError += error;
+            pairs++;
+        }
+    }
+    std::cout << "movies: " << rows.size() << ", attributes: " << dims << std::endl;
+    std::cout << "memory: " << quantized.bytes() << " bytes 8 bit, "
+              << rows.size() * dims * sizeof(double) << " bytes double" << std::endl;
+    std::cout << "pair cosine error: max " << maxError << ", mean " << sumError / pairs
+              << std::endl;
+    std::cout << "all pairs: " << int8Seconds * 1000.0 << " ms 8 bit, " << doubleSeconds * 1000.0
+              << " ms double (checksum " << checksum << ")" << std::endl;
+
+    // content recommendations
+    RecommenderSystem exactRs;
+    RecommenderSystem quantizedRs;
+    if (exactRs.loadData(argv[1], argv[2]) != 0 || quantizedRs.loadData(argv[1], argv[2]) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    quantizedRs.buildQuantizedAttributes();
+    std::vector<std::string> clients = readNames(argv[2], true);
+    size_t agree = 0;
+    for (const std::string &client : clients)
+    {
+        agree += (exactRs.recommendByContent(client) ==
+                  quantizedRs.recommendByContentQuantized(client));
+    }
+    std::cout << "recommendByContent agreement: " << agree << " / " << clients.size() << std::endl;
+
+    // cf predictions through the neighbor lists
+    exactRs.buildMovieNeighbors(m);
+    quantizedRs.buildMovieNeighbors(m, true);
+    std::vector<std::string> movies = readNames(argv[1], false);
+    size_t predictions = 0;
+    size_t same = 0;
+    double maxPredictionError = 0.0;
+    for (const std::string &client : clients)
+    {
+        for (size_t i = 0; i < movies.size() && i < PREDICTED_MOVIES; i++)
+        {
+            double exact = exactRs.predictMovieScoreForUser(movies[i], client, k);
+            double approx = quantizedRs.predictMovieScoreForUser(movies[i], client, k);
+            same += (exact == approx);
+            maxPredictionError = std::max(maxPredictionError, std::fabs(exact - approx));
+            predictions++;
+        }
+    }
+    std::cout << "predictMovieScoreForUser (k = " << k << ", m = " << m << ") identical: " << same
+              << " / " << predictions << ", max error " << maxPredictionError << std::endl;
+    return EXIT_SUCCESS;
+}
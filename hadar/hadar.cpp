@@ -4,9 +4,16 @@
 
 #include "hadar.h"
 
+namespace hadar
+{
 
 bool gFirstLine = true;
 
+string RecommenderSystem::engineName() const
+{
+    return "hadar";
+}
+
 // --------------------------------- PARSING FILES ----------------------------------------------//
 
 void RecommenderSystem::_parseStringLine(const string &line, vector<string> &vec)
@@ -79,7 +86,7 @@ bool RecommenderSystem::_parseFile(const string &filePath, bool isUserRankFile)
     return SUCCESS;
 }
 
-bool
+int
 RecommenderSystem::loadData(const string &moviesAttributesFilePath, const string &userRanksFilePath)
 {
     bool cond1 = _parseFile(moviesAttributesFilePath, false);
@@ -328,28 +335,4 @@ string RecommenderSystem::getMovieWithMaxResemblance(vector<std::pair<string, do
 }
 
 
-int main()
-{
-    string moviePath = "movies_small.txt";
-    string ranksPath = "ranks_small.txt";
-    RecommenderSystem obj;
-    obj.loadData(moviePath, ranksPath);
-    std::cout << obj.recommendByContent("Molly") << std::endl;
-}
-
-std::vector<resMovie> RecommenderSystem::_findMovieByHistory(const std::vector<double> &movieAttributes,
-                                                             const std::map<std::string, double> &userHistory)
-{
-    std::vector<resMovie> res;
-    double movieNorm = _norm(movieAttributes);
-    for (const auto& pair : userHistory)
-    {
-        double curNorm = _norm(_movies[pair.first]) * movieNorm;
-        double curScore = _dotProd(movieAttributes, _movies[pair.first]) * (1 / curNorm);
-        resMovie curMovie = {.score = curScore, .name = pair.first};
-        res.push_back(curMovie);
-    }
-    std::sort (res.begin(), res.end());
-    std::reverse(res.begin(), res.end());
-    return res;
-}
+} // namespace hadar
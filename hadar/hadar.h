@@ -16,6 +16,8 @@
 #include <algorithm>
 #include <cmath>
 #include <float.h>
+#include <sstream>
+#include "RecommenderEngine.h"
 
 #define SUCCESS 0
 #define FAILURE 1
@@ -27,6 +29,15 @@
 #define DOUBLE_INDICATOR (0.0)
 
 
+/**
+ * a second, independent implementation of the recommender, kept in its own namespace so it can
+ * be linked next to ::RecommenderSystem and compared with it (see bench/EngineCompare.cpp).
+ * its macros above, NA among them, clash with the constants of RecommenderSystem.cpp, so this
+ * header stays out of that translation unit.
+ */
+namespace hadar
+{
+
 using std::string;
 using std::cerr;
 using std::endl;
@@ -36,23 +47,28 @@ using std::vector;
  *based on movie attributes file and a user ranks file, the class is responsible
  * of generating relevant recommendations to the user, in multiple ways.
  */
-class RecommenderSystem
+class RecommenderSystem : public RecommenderEngine
 {
 public:
+    /**
+     * @return "hadar", the name of this implementation
+     */
+    string engineName() const override;
+
     /**
      * loads the data to our recommendation system
      * @param moviesAttributesFilePath - filepath to movies attributes matrix
      * @param userRanksFilePath - filepath to user ranks matrix
      * @return 0 upon success, 1 otherwise.
      */
-    bool loadData(const string &moviesAttributesFilePath, const string &userRanksFilePath);
+    int loadData(const string &moviesAttributesFilePath, const string &userRanksFilePath) override;
 
     /**
      *generates a recommendation based on the content
      * @param userName - customer's user name
      * @return string - representing the recommended movie returned by the algorithm
      */
-    string recommendByContent(const string &userName);
+    string recommendByContent(const string &userName) override;
 
     /**
      * generates a prediction for a user's rank to a movie he hasn't seen yet, based
@@ -62,7 +78,8 @@ public:
      * @param k - number of movies that are most similar to movieName
      * @return -1 if no such user or movie, float predicted rating otherwize
      */
-    double predictMovieScoreForUser(const string &movieName, const string &userName, int k);
+    double predictMovieScoreForUser(const string &movieName, const string &userName,
+                                    int k) override;
 
     /**
      * recommends a movie to the user based on the predictMovieScoreForUser algorithm
@@ -70,7 +87,7 @@ public:
      * @param k - number of movies that are most similar to movieName
      * @return string representing the name of the recommended movie
      */
-    string recommendByCF(const string &userName, int k);
+    string recommendByCF(const string &userName, int k) override;
 
 
 private:
@@ -204,6 +221,7 @@ private:
 
 };
 
+} // namespace hadar
 
 
 #endif //EX5_HADAR_H